@@ -34,14 +34,36 @@
 #define BUF_SIZE_FIFO          2048U
 #endif
 
+// Batch timestamp into FIFO with every sample: 1 = enabled, 0 = disabled
+// (default: enabled when the demo records hardware timestamps, REC_TIMESTAMP_HW)
+#ifndef FIFO_TIMESTAMP
+#if defined(REC_TIMESTAMP_HW) && (REC_TIMESTAMP_HW != 0)
+#define FIFO_TIMESTAMP         1U
+#else
+#define FIFO_TIMESTAMP         0U
+#endif
+#endif
+
 #define SAMPLE_SIZE            6U
 
+// Timestamp of sample received before the first timestamp word
+#define TS_INVALID             UINT64_MAX
+
+// FIFO word tags
+#define TAG_GYROSCOPE          1U
+#define TAG_ACCELEROMETER      2U
+#define TAG_TIMESTAMP          4U
+
 extern ISM330DHCX_Object_t ISM330DHCX_Obj;
 
 /// Buffer control Block
 typedef struct {
-  uint8_t *buf;
-  uint32_t size;
+  uint8_t  *buf;
+  uint32_t  size;
+#if (FIFO_TIMESTAMP != 0U)
+  uint64_t *ts_buf;                     // Timestamps of buffered samples (TS_INVALID: not available)
+  uint32_t  ts_num;                     // Number of timestamps in ts_buf
+#endif
 } const ism330dhcx_buf_cb_t;
 
 /// Control Block
@@ -49,14 +71,39 @@ typedef struct {
   ism330dhcx_buf_cb_t *buf_cb;
   uint32_t             head;
   uint32_t             tail;
+#if (FIFO_TIMESTAMP != 0U)
+  uint32_t             ts_head;         // Timestamp index of next written sample
+  uint32_t             ts_tail;         // Timestamp index of next read sample
+  uint32_t             ts_valid;        // Timestamp of last read is valid
+  uint64_t             timestamp;       // Timestamp of first sample of last read
+#endif
 } ism330dhcx_cb_t;
 
 static uint8_t buf_gyroscope[BUF_SIZE_GYROSCOPE];
 static uint8_t buf_accelerometer[BUF_SIZE_ACCELEROMETER];
 static uint8_t buf_fifo[BUF_SIZE_FIFO];
 
+#if (FIFO_TIMESTAMP != 0U)
+static uint64_t ts_buf_gyroscope[BUF_SIZE_GYROSCOPE / SAMPLE_SIZE];
+static uint64_t ts_buf_accelerometer[BUF_SIZE_ACCELEROMETER / SAMPLE_SIZE];
+
+static ism330dhcx_buf_cb_t ism330dhcx_buf_cb[2] = {
+  {buf_gyroscope,     sizeof(buf_gyroscope),     ts_buf_gyroscope,     BUF_SIZE_GYROSCOPE / SAMPLE_SIZE},
+  {buf_accelerometer, sizeof(buf_accelerometer), ts_buf_accelerometer, BUF_SIZE_ACCELEROMETER / SAMPLE_SIZE}
+};
+
+/// Timestamp decoder
+static struct {
+  uint32_t valid;                       // Timestamp word received
+  uint32_t resolution;                  // Timestamp resolution in ns
+  uint32_t last;                        // Last timestamp word value
+  uint32_t high;                        // Timestamp extension (incremented on counter rollover)
+  uint64_t time;                        // Current timestamp in microseconds
+} ism330dhcx_ts = {0};
+#else
 static ism330dhcx_buf_cb_t ism330dhcx_buf_cb[2] = {{buf_gyroscope,     sizeof(buf_gyroscope)},
                                                    {buf_accelerometer, sizeof(buf_accelerometer)}};
+#endif
 static ism330dhcx_cb_t ism330dhcx_cb[2] = {0};
 
 // Write data to buffer
@@ -107,17 +154,87 @@ static uint32_t Buffer_Read (ism330dhcx_cb_t *cb, uint8_t *buf, uint32_t buf_siz
   return cnt;
 }
 
+#if (FIFO_TIMESTAMP != 0U)
+// Enable timestamp counter and batching of timestamp into FIFO
+static int32_t Timestamp_Enable (void) {
+  stmdev_ctx_t *ctx = &ISM330DHCX_Obj.Ctx;
+  int8_t        freq_fine;
+
+  // Timestamp resolution: 25us typical, corrected with internal frequency trimming
+  if (ctx->read_reg(ctx->handle, ISM330DHCX_INTERNAL_FREQ_FINE, (uint8_t *)&freq_fine, 1) != 0) {
+    return -1;
+  }
+  ism330dhcx_ts.resolution = 250000000U / (uint32_t)(10000 + (15 * freq_fine));
+  ism330dhcx_ts.valid      = 0U;
+  ism330dhcx_ts.last       = 0U;
+  ism330dhcx_ts.high       = 0U;
+
+  if (ism330dhcx_timestamp_set(ctx, PROPERTY_ENABLE) != 0) {
+    return -1;
+  }
+  if (ism330dhcx_fifo_timestamp_decimation_set(ctx, ISM330DHCX_DEC_1) != 0) {
+    return -1;
+  }
+  return 0;
+}
+
+// Decode timestamp word (32-bit counter, extended to 64-bit microseconds)
+static void Timestamp_Decode (const uint8_t *word) {
+  uint32_t ts;
+
+  ts = (uint32_t)word[0]         | ((uint32_t)word[1] << 8) |
+      ((uint32_t)word[2] << 16)  | ((uint32_t)word[3] << 24);
+  if ((ism330dhcx_ts.valid != 0U) && (ts < ism330dhcx_ts.last)) {
+    ism330dhcx_ts.high++;
+  }
+  ism330dhcx_ts.last  = ts;
+  ism330dhcx_ts.time  = ((((uint64_t)ism330dhcx_ts.high << 32) | ts) * ism330dhcx_ts.resolution) / 1000U;
+  ism330dhcx_ts.valid = 1U;
+}
+
+// Write sample and its timestamp to buffer (sample is discarded when buffer is full)
+static uint32_t Sample_Write (ism330dhcx_cb_t *cb, uint8_t *sample) {
+
+  if ((cb->buf_cb->size - (cb->head - cb->tail)) < SAMPLE_SIZE) {
+    return 0U;
+  }
+  cb->buf_cb->ts_buf[cb->ts_head] = (ism330dhcx_ts.valid != 0U) ? ism330dhcx_ts.time : TS_INVALID;
+  if (++cb->ts_head == cb->buf_cb->ts_num) {
+    cb->ts_head = 0U;
+  }
+  return Buffer_Write(cb, sample, SAMPLE_SIZE);
+}
+#else
+// Write sample to buffer
+static uint32_t Sample_Write (ism330dhcx_cb_t *cb, uint8_t *sample) {
+  return Buffer_Write(cb, sample, SAMPLE_SIZE);
+}
+#endif
+
 // FIFO initialize
 int32_t ISM330DHCX_FIFO_Init (uint32_t id) {
   ism330dhcx_cb_t *cb;
   int32_t          ret = -1;
 
   if ((id == ISM330DHCX_ID_GYROSCOPE) || (id == ISM330DHCX_ID_ACCELEROMETER)) {
+#if (FIFO_TIMESTAMP != 0U)
+    if ((ism330dhcx_cb[ISM330DHCX_ID_GYROSCOPE].buf_cb     == NULL) &&
+        (ism330dhcx_cb[ISM330DHCX_ID_ACCELEROMETER].buf_cb == NULL)) {
+      if (Timestamp_Enable() != 0) {
+        return -1;
+      }
+    }
+#endif
     cb = &ism330dhcx_cb[id];
 
     cb->buf_cb = &ism330dhcx_buf_cb[id];
     cb->head   = 0U;
     cb->tail   = 0U;
+#if (FIFO_TIMESTAMP != 0U)
+    cb->ts_head  = 0U;
+    cb->ts_tail  = 0U;
+    cb->ts_valid = 0U;
+#endif
 
     ret = 0;
   }
@@ -163,6 +280,15 @@ uint32_t ISM330DHCX_FIFO_Read (uint32_t id, uint32_t num_samples, uint8_t *buf)
   
   if (err == 0) {
     num = Buffer_Read(cb, buf, num_samples * SAMPLE_SIZE) / SAMPLE_SIZE;
+#if (FIFO_TIMESTAMP != 0U)
+    // Timestamp of first sample: from buffer or from FIFO (below)
+    cb->ts_valid = 0U;
+    if (num != 0U) {
+      cb->timestamp = cb->buf_cb->ts_buf[cb->ts_tail];
+      cb->ts_valid  = (cb->timestamp != TS_INVALID) ? 1U : 0U;
+      cb->ts_tail   = (cb->ts_tail + num) % cb->buf_cb->ts_num;
+    }
+#endif
 
     if (num < num_samples) {
 
@@ -186,29 +312,41 @@ uint32_t ISM330DHCX_FIFO_Read (uint32_t id, uint32_t num_samples, uint8_t *buf)
         if (ctx->read_reg(ctx->handle, ISM330DHCX_FIFO_DATA_OUT_TAG, buf_fifo, cnt) == 0) {
           for (idx = 0U; idx < cnt; idx += 7) {
             tag = buf_fifo[idx] >> 3;
-            if (tag == ISM330DHCX_TAG(id)) {
+            if ((tag == ISM330DHCX_TAG(id)) && (num < num_samples)) {
+#if (FIFO_TIMESTAMP != 0U)
+              if (num == 0U) {
+                cb->timestamp = ism330dhcx_ts.time;
+                cb->ts_valid  = ism330dhcx_ts.valid;
+              }
+#endif
               memcpy(buf + (num * SAMPLE_SIZE), &buf_fifo[idx+1], SAMPLE_SIZE);
               num++;
             } else {
               switch (tag) {
-                case 1:
+                case TAG_GYROSCOPE:
                   // Gyroscope
                   if (ism330dhcx_cb[ISM330DHCX_ID_GYROSCOPE].buf_cb != NULL) {
-                    if (Buffer_Write(&ism330dhcx_cb[ISM330DHCX_ID_GYROSCOPE], &buf_fifo[idx+1], SAMPLE_SIZE) != SAMPLE_SIZE) {
+                    if (Sample_Write(&ism330dhcx_cb[ISM330DHCX_ID_GYROSCOPE], &buf_fifo[idx+1]) != SAMPLE_SIZE) {
                       // Sample lost
 //                      printf("ERROR: Gyroscope buffer overflow\r\n");
                     }
                   }
                   break;
-                case 2:
+                case TAG_ACCELEROMETER:
                   // Accelerometer
                   if (ism330dhcx_cb[ISM330DHCX_ID_ACCELEROMETER].buf_cb != NULL) {
-                    if (Buffer_Write(&ism330dhcx_cb[ISM330DHCX_ID_ACCELEROMETER], &buf_fifo[idx+1], SAMPLE_SIZE) != SAMPLE_SIZE) {
+                    if (Sample_Write(&ism330dhcx_cb[ISM330DHCX_ID_ACCELEROMETER], &buf_fifo[idx+1]) != SAMPLE_SIZE) {
                       //  Sample lost
 //                      printf("ERROR: Accelerometer buffer overflow\r\n");
                     }
                   }
                   break;
+#if (FIFO_TIMESTAMP != 0U)
+                case TAG_TIMESTAMP:
+                  // Timestamp of following samples
+                  Timestamp_Decode(&buf_fifo[idx+1]);
+                  break;
+#endif
               }
             }
           }
@@ -218,3 +356,21 @@ uint32_t ISM330DHCX_FIFO_Read (uint32_t id, uint32_t num_samples, uint8_t *buf)
   }
   return num;
 }
+
+// Get timestamp of first sample of last read
+int32_t ISM330DHCX_FIFO_GetTimestamp (uint32_t id, uint64_t *timestamp) {
+  int32_t ret = -1;
+
+#if (FIFO_TIMESTAMP != 0U)
+  if (((id == ISM330DHCX_ID_GYROSCOPE) || (id == ISM330DHCX_ID_ACCELEROMETER)) && (timestamp != NULL)) {
+    if (ism330dhcx_cb[id].ts_valid != 0U) {
+      *timestamp = ism330dhcx_cb[id].timestamp;
+      ret = 0;
+    }
+  }
+#else
+  (void)id;
+  (void)timestamp;
+#endif
+  return ret;
+}
@@ -57,4 +57,13 @@ int32_t ISM330DHCX_FIFO_Uninit (uint32_t id);
 */
 uint32_t ISM330DHCX_FIFO_Read (uint32_t id, uint32_t num_samples, uint8_t *buf);
 
+/**
+  \fn          int32_t ISM330DHCX_FIFO_GetTimestamp (uint32_t id, uint64_t *timestamp)
+  \brief       Get hardware timestamp of first sample returned by last ISM330DHCX_FIFO_Read.
+  \param[in]   id          ISM330DHCX_ID_GYROSCOPE or ISM330DHCX_ID_ACCELEROMETER
+  \param[out]  timestamp   pointer to timestamp in microseconds
+  \return      0=Ok, -1=Error (no timestamp available)
+*/
+int32_t ISM330DHCX_FIFO_GetTimestamp (uint32_t id, uint64_t *timestamp);
+
 #endif  /* ISM330DHCX_FIFO_H */
@@ -142,6 +142,7 @@ sensorDrvHW_t sensorDrvHW_0 = {
   TemperatureSensor_Disable,
   TemperatureSensor_GetOverflow,
   TemperatureSensor_ReadSamples,
+  NULL,
   NULL
 };
 
@@ -207,6 +208,7 @@ sensorDrvHW_t sensorDrvHW_1 = {
   HumiditySensor_Disable,
   HumiditySensor_GetOverflow,
   HumiditySensor_ReadSamples,
+  NULL,
   NULL
 };
 
@@ -270,6 +272,7 @@ sensorDrvHW_t sensorDrvHW_2 = {
   PressureSensor_Disable,
   PressureSensor_GetOverflow,
   PressureSensor_ReadSamples,
+  NULL,
   NULL
 };
 
@@ -327,13 +330,26 @@ static uint32_t Accelerometer_ReadSamples (uint32_t num_samples, void *buf) {
   return num;
 }
 
+static int32_t Accelerometer_GetTimestamp (uint64_t *timestamp) {
+  int32_t ret = SENSOR_ERROR;
+
+  sensorLock();
+  if (ISM330DHCX_FIFO_GetTimestamp(ISM330DHCX_ID_ACCELEROMETER, timestamp) == 0) {
+    ret = SENSOR_OK;
+  }
+  sensorUnLock();
+
+  return ret;
+}
+
 sensorDrvHW_t sensorDrvHW_3 = {
   NULL,
   Accelerometer_Enable,
   Accelerometer_Disable,
   Accelerometer_GetOverflow,
   Accelerometer_ReadSamples,
-  NULL
+  NULL,
+  Accelerometer_GetTimestamp
 };
 
 
@@ -390,13 +406,26 @@ static uint32_t Gyroscope_ReadSamples (uint32_t num_samples, void *buf) {
   return num;
 }
 
+static int32_t Gyroscope_GetTimestamp (uint64_t *timestamp) {
+  int32_t ret = SENSOR_ERROR;
+
+  sensorLock();
+  if (ISM330DHCX_FIFO_GetTimestamp(ISM330DHCX_ID_GYROSCOPE, timestamp) == 0) {
+    ret = SENSOR_OK;
+  }
+  sensorUnLock();
+
+  return ret;
+}
+
 sensorDrvHW_t sensorDrvHW_4 = {
   NULL,
   Gyroscope_Enable,
   Gyroscope_Disable,
   Gyroscope_GetOverflow,
   Gyroscope_ReadSamples,
-  NULL
+  NULL,
+  Gyroscope_GetTimestamp
 };
 
 
@@ -459,6 +488,7 @@ sensorDrvHW_t sensorDrvHW_5 = {
   Magnetometer_Disable,
   Magnetometer_GetOverflow,
   Magnetometer_ReadSamples,
+  NULL,
   NULL
 };
 
@@ -546,5 +576,6 @@ sensorDrvHW_t sensorDrvHW_6 = {
   Microphone_Disable,
   Microphone_GetOverflow,
   NULL,
-  Microphone_GetBlockData
+  Microphone_GetBlockData,
+  NULL
 };
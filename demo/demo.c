@@ -68,6 +68,17 @@
 #ifndef REC_IO_THRESHOLD_TEMPERATURE_SENSOR
 #define REC_IO_THRESHOLD_TEMPERATURE_SENSOR 0
 #endif
+#ifndef REC_CODEC_ACCELEROMETER
+#define REC_CODEC_ACCELEROMETER             SDS_CODEC_DELTA
+#endif
+#ifndef REC_CODEC_GYROSCOPE
+#define REC_CODEC_GYROSCOPE                 SDS_CODEC_DELTA
+#endif
+// Record accelerometer and gyroscope with hardware sample timestamps (64-bit, microseconds):
+// requires tick-frequency: 1000000 in Accelerometer.sds.yml and Gyroscope.sds.yml
+#ifndef REC_TIMESTAMP_HW
+#define REC_TIMESTAMP_HW                    0
+#endif
 #endif
 
 #ifndef SENSOR_POLLING_INTERVAL
@@ -108,6 +119,17 @@ static sdsRecId_t recId_temperatureSensor             = NULL;
 static uint8_t recBuf_accelerometer[REC_BUF_SIZE_ACCELEROMETER];
 static uint8_t recBuf_gyroscope[REC_BUF_SIZE_GYROSCOPE];
 static uint8_t recBuf_temperatureSensor[REC_BUF_SIZE_TEMPERATURE_SENSOR];
+
+#if (REC_TIMESTAMP_HW != 0)
+// Hardware time of sensor records
+typedef struct {
+  uint64_t next;                        // Expected timestamp of next record in microseconds
+  uint32_t valid;                       // Hardware timestamp received
+} timestampHw_t;
+
+static timestampHw_t timestampHw_accelerometer;
+static timestampHw_t timestampHw_gyroscope;
+#endif
 #endif
 
 // Temporary sensor buffer
@@ -134,10 +156,30 @@ static osThreadId_t thrId_read_sensors   = NULL;
 
 #define EVENT_CLOSE                     (1U << 0)
 
+#if defined(RECORDER_ENABLED) && (REC_TIMESTAMP_HW != 0)
+// Get hardware timestamp of first sample of record with num samples, return 0 on success.
+// When the sensor provides no timestamp, the time continues from the previous record at the nominal sample interval
+// (kernel time is not used: it has a different time base). Records are skipped until a hardware timestamp is received.
+static int32_t get_timestamp_hw (sensorId_t id, sensorConfig_t *config, timestampHw_t *ts, uint32_t num, uint64_t *timestamp) {
+  if (sensorGetTimestamp(id, timestamp) != SENSOR_OK) {
+    if (ts->valid == 0U) {
+      return -1;
+    }
+    *timestamp = ts->next;
+  }
+  ts->valid = 1U;
+  ts->next  = *timestamp + ((uint64_t)num * config->u.fifo.sample_interval);
+  return 0;
+}
+#endif
+
 // Read sensor thread
 static __NO_RETURN void read_sensors (void *argument) {
   uint32_t num, buf_size;
   uint32_t timestamp;
+#if defined(RECORDER_ENABLED) && (REC_TIMESTAMP_HW != 0)
+  uint64_t timestamp_hw;
+#endif
   (void)   argument;
 
   timestamp = osKernelGetTickCount();
@@ -153,7 +195,16 @@ static __NO_RETURN void read_sensors (void *argument) {
             printf("%s: SDS write failed\r\n", sensorConfig_accelerometer->name);
           }
 #ifdef RECORDER_ENABLED
+#if (REC_TIMESTAMP_HW != 0)
+          // Hardware timestamp of first sample (record skipped until hardware time is available)
+          num = buf_size;
+          if (get_timestamp_hw(sensorId_accelerometer, sensorConfig_accelerometer, &timestampHw_accelerometer,
+                               buf_size / sensorConfig_accelerometer->sample_size, &timestamp_hw) == 0) {
+            num = sdsRecWrite64(recId_accelerometer, timestamp_hw, sensorBuf, buf_size);
+          }
+#else
           num = sdsRecWrite(recId_accelerometer, timestamp, sensorBuf, buf_size);
+#endif
           if (num != buf_size) {
             printf("%s: Recorder write failed\r\n", sensorConfig_accelerometer->name);
           }
@@ -171,7 +222,16 @@ static __NO_RETURN void read_sensors (void *argument) {
             printf("%s: SDS write failed\r\n", sensorConfig_gyroscope->name);
           }
 #ifdef RECORDER_ENABLED
+#if (REC_TIMESTAMP_HW != 0)
+          // Hardware timestamp of first sample (record skipped until hardware time is available)
+          num = buf_size;
+          if (get_timestamp_hw(sensorId_gyroscope, sensorConfig_gyroscope, &timestampHw_gyroscope,
+                               buf_size / sensorConfig_gyroscope->sample_size, &timestamp_hw) == 0) {
+            num = sdsRecWrite64(recId_gyroscope, timestamp_hw, sensorBuf, buf_size);
+          }
+#else
           num = sdsRecWrite(recId_gyroscope, timestamp, sensorBuf, buf_size);
+#endif
           if (num != buf_size) {
             printf("%s: Recorder write failed\r\n", sensorConfig_gyroscope->name);
           }
@@ -277,6 +337,8 @@ static void button_event (void) {
                                       recBuf_accelerometer,
                                       sizeof(recBuf_accelerometer),
                                       REC_IO_THRESHOLD_ACCELEROMETER);
+    // Compress records (x, y, z: int16_t)
+    sdsRecSetCodec(recId_accelerometer, REC_CODEC_ACCELEROMETER, sizeof(int16_t), 3U);
 #endif
     sensorEnable(sensorId_accelerometer);
     printf("Accelerometer enabled\r\n");
@@ -289,6 +351,8 @@ static void button_event (void) {
                                   recBuf_gyroscope,
                                   sizeof(recBuf_gyroscope),
                                   REC_IO_THRESHOLD_GYROSCOPE);
+    // Compress records (x, y, z: int16_t)
+    sdsRecSetCodec(recId_gyroscope, REC_CODEC_GYROSCOPE, sizeof(int16_t), 3U);
 #endif
     sensorEnable(sensorId_gyroscope);
     printf("Gyroscope enabled\r\n");
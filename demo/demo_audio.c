@@ -34,6 +34,12 @@
 #ifndef REC_IO_THRESHOLD_MICROPHONE
 #define REC_IO_THRESHOLD_MICROPHONE         0
 #endif
+#ifndef REC_CODEC_MICROPHONE
+#define REC_CODEC_MICROPHONE                SDS_CODEC_RICE
+#endif
+#ifndef REC_CHANNELS_MICROPHONE
+#define REC_CHANNELS_MICROPHONE             1U
+#endif
 
 #ifndef SENSOR_POLLING_INTERVAL
 #define SENSOR_POLLING_INTERVAL             150U  /* 150ms */
@@ -139,6 +145,8 @@ static void button_event (void) {
                                   recBuf_microphone,
                                   sizeof(recBuf_microphone),
                                   REC_IO_THRESHOLD_MICROPHONE);
+    // Lossless audio compression (int16_t PCM)
+    sdsRecSetCodec(recId_microphone, REC_CODEC_MICROPHONE, sizeof(int16_t), REC_CHANNELS_MICROPHONE);
     sensorEnable(sensorId_microphone);
     printf("Microphone enabled\r\n");
 
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2023 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SDS_CODEC_H
+#define SDS_CODEC_H
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+// ==== Synchronous Data Stream Codec ====
+
+/// Codec identifiers
+#define SDS_CODEC_NONE          0U          ///< No compression
+#define SDS_CODEC_DELTA         1U          ///< Delta + zigzag + bit-packing of integer samples
+#define SDS_CODEC_LZ            2U          ///< LZ compression (LZ4 block format)
+#define SDS_CODEC_RICE          3U          ///< Fixed linear prediction + Rice coding of int16_t samples (lossless audio)
+
+/// Maximum number of interleaved channels (SDS_CODEC_DELTA and SDS_CODEC_RICE)
+#define SDS_CODEC_MAX_CHANNELS  16U
+
+/// Codec header size (codec, sample size, channels, reserved, decoded size)
+#define SDS_CODEC_HEADER_SIZE   8U
+
+/**
+  \fn          uint32_t sdsCodecEncode (uint32_t codec, uint32_t sample_size, uint32_t channels,
+                                        const void *in, uint32_t in_size, void *out, uint32_t out_size)
+  \brief       Encode data block (codec header followed by encoded data).
+  \param[in]   codec          codec identifier (SDS_CODEC_DELTA, SDS_CODEC_LZ or SDS_CODEC_RICE)
+  \param[in]   sample_size    sample size in bytes: 1, 2 or 4 (SDS_CODEC_DELTA), 2 (SDS_CODEC_RICE)
+  \param[in]   channels       number of interleaved channels (SDS_CODEC_DELTA and SDS_CODEC_RICE)
+  \param[in]   in             pointer to buffer with data to encode
+  \param[in]   in_size        data size in bytes
+  \param[out]  out            pointer to buffer for encoded data
+  \param[in]   out_size       buffer size in bytes
+  \return      number of bytes in out buffer or 0 when encoded data does not fit into out buffer
+*/
+uint32_t sdsCodecEncode (uint32_t codec, uint32_t sample_size, uint32_t channels,
+                         const void *in, uint32_t in_size, void *out, uint32_t out_size);
+
+/**
+  \fn          uint32_t sdsCodecDecode (const void *in, uint32_t in_size, void *out, uint32_t out_size)
+  \brief       Decode data block (codec header followed by encoded data).
+  \param[in]   in             pointer to buffer with encoded data
+  \param[in]   in_size        encoded data size in bytes
+  \param[out]  out            pointer to buffer for decoded data
+  \param[in]   out_size       buffer size in bytes
+  \return      number of decoded bytes or 0 on error
+*/
+uint32_t sdsCodecDecode (const void *in, uint32_t in_size, void *out, uint32_t out_size);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* SDS_CODEC_H */
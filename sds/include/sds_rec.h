@@ -26,6 +26,8 @@ extern "C"
 
 #include <stdint.h>
 
+#include "sds_codec.h"
+
 // ==== SDS Recorder ====
 
 /// Identifier
@@ -37,6 +39,7 @@ typedef void *sdsRecId_t;
 
 /// Events
 #define SDS_REC_EVENT_IO_ERROR  (1UL << 0)  ///< I/O Error
+#define SDS_REC_EVENT_DATA_LOST (1UL << 1)  ///< Data acknowledged as not persisted by the server
 
 /// Event callback function
 typedef void (*sdsRecEvent_t) (sdsRecId_t id, uint32_t event);
@@ -67,6 +70,17 @@ int32_t sdsRecUninit (void);
 */
 sdsRecId_t sdsRecOpen (const char *name, void *buf, uint32_t buf_size, uint32_t io_threshold);
 
+/**
+  \fn          int32_t sdsRecSetCodec (sdsRecId_t id, uint32_t codec, uint32_t sample_size, uint32_t channels)
+  \brief       Set codec used to compress records of recorder stream (call before writing).
+  \param[in]   id             \ref sdsRecId_t
+  \param[in]   codec          codec identifier (SDS_CODEC_NONE, SDS_CODEC_DELTA, SDS_CODEC_LZ or SDS_CODEC_RICE)
+  \param[in]   sample_size    sample size in bytes of integer channels: 1, 2 or 4 (SDS_CODEC_DELTA), 2 (SDS_CODEC_RICE)
+  \param[in]   channels       number of interleaved channels (SDS_CODEC_DELTA and SDS_CODEC_RICE)
+  \return      return code
+*/
+int32_t sdsRecSetCodec (sdsRecId_t id, uint32_t codec, uint32_t sample_size, uint32_t channels);
+
 /**
   \fn          int32_t sdsRecClose (sdsRecId_t id)
   \brief       Close recorder stream.
@@ -86,6 +100,17 @@ int32_t sdsRecClose (sdsRecId_t id);
 */
 uint32_t sdsRecWrite (sdsRecId_t id, uint32_t timestamp, const void *buf, uint32_t buf_size);
 
+/**
+  \fn          uint32_t sdsRecWrite64 (sdsRecId_t id, uint64_t timestamp, const void *buf, uint32_t buf_size)
+  \brief       Write data with 64-bit timestamp to recorder stream.
+  \param[in]   id             \ref sdsRecId_t
+  \param[in]   timestamp      64-bit record timestamp (for example in microseconds or DWT cycles)
+  \param[in]   buf            pointer to buffer with data to write
+  \param[in]   buf_size       buffer size in bytes
+  \return      number of data bytes written
+*/
+uint32_t sdsRecWrite64 (sdsRecId_t id, uint64_t timestamp, const void *buf, uint32_t buf_size);
+
 #ifdef  __cplusplus
 }
 #endif
@@ -41,6 +41,16 @@ typedef enum {
 #define SDSIO_OK                (0)         ///< Operation completed successfully
 #define SDSIO_ERROR             (-1)        ///< Operation failed
 
+/// Stream information
+typedef struct {
+  uint32_t bytes_sent;          ///< Number of bytes sent (modulo 2^32)
+  uint32_t bytes_acked;         ///< Number of bytes persisted as acknowledged by the server (modulo 2^32)
+  uint32_t bytes_lost;          ///< Number of bytes which the server could not persist
+} sdsioInfo_t;
+
+/// Write completion callback function
+typedef void (*sdsioWriteDone_t) (sdsioId_t id, const void *buf, uint32_t num, void *arg);
+
 /**
   \fn          int32_t sdsioInit (void)
   \brief       Initialize SDS I/O.
@@ -67,6 +77,9 @@ sdsioId_t sdsioOpen (const char *name, sdsioMode_t mode);
 /**
   \fn          int32_t sdsioClose (sdsioId_t id)
   \brief       Close I/O stream.
+               Asynchronous writes of the stream submitted before are completed (their completion callbacks
+               are called) before the stream is closed. Function must not be called from a completion callback
+               and no further writes shall be submitted for the stream.
   \param[in]   id             \ref sdsioId_t
   \return      return code
 */
@@ -82,6 +95,18 @@ int32_t sdsioClose (sdsioId_t id);
 */
 uint32_t sdsioWrite (sdsioId_t id, const void *buf, uint32_t buf_size);
 
+/**
+  \fn          int32_t sdsioWriteAsync (sdsioId_t id, const void *buf, uint32_t buf_size, sdsioWriteDone_t cb, void *arg)
+  \brief       Submit asynchronous write to I/O stream.
+  \param[in]   id             \ref sdsioId_t
+  \param[in]   buf            pointer to buffer with data to write (valid until completion)
+  \param[in]   buf_size       buffer size in bytes
+  \param[in]   cb             pointer to \ref sdsioWriteDone_t (called with number of bytes written)
+  \param[in]   arg            user argument passed to completion callback
+  \return      return code
+*/
+int32_t sdsioWriteAsync (sdsioId_t id, const void *buf, uint32_t buf_size, sdsioWriteDone_t cb, void *arg);
+
 /**
   \fn          uint32_t sdsioRead (sdsioId_t id, void *buf, uint32_t buf_size)
   \brief       Read data from I/O stream.
@@ -92,6 +117,15 @@ uint32_t sdsioWrite (sdsioId_t id, const void *buf, uint32_t buf_size);
 */
 uint32_t sdsioRead (sdsioId_t id, void *buf, uint32_t buf_size);
 
+/**
+  \fn          int32_t sdsioGetInfo (sdsioId_t id, sdsioInfo_t *info)
+  \brief       Get I/O stream information.
+  \param[in]   id             \ref sdsioId_t
+  \param[out]  info           pointer to \ref sdsioInfo_t
+  \return      return code
+*/
+int32_t sdsioGetInfo (sdsioId_t id, sdsioInfo_t *info);
+
 #ifdef  __cplusplus
 }
 #endif
@@ -0,0 +1,593 @@
+/*
+ * Copyright (c) 2023 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// SDS Codec
+
+#include <string.h>
+
+#include "sds_codec.h"
+
+// Configuration
+#ifndef SDS_CODEC_LZ_HASH_BITS
+#define SDS_CODEC_LZ_HASH_BITS  10U
+#endif
+
+// Delta codec: number of samples in a bit-packed group
+#define DELTA_GROUP_SIZE        16U
+
+// LZ codec (LZ4 block format)
+#define LZ_MIN_MATCH            4U      // Minimum match length
+#define LZ_LAST_LITERALS        5U      // Last bytes of a block are literals
+#define LZ_MF_LIMIT             12U     // Last match starts at least 12 bytes before end of block
+#define LZ_MAX_INPUT            65535U  // Block size limit (16-bit positions and offsets)
+
+// Rice codec (fixed linear prediction and Rice coding of 16-bit samples)
+#define RICE_MAX_ORDER          4U      // Maximum fixed predictor order
+#define RICE_PARTITION_SIZE     64U     // Number of residuals coded with the same Rice parameter
+#define RICE_PARAM_BITS         5U      // Rice parameter size in bits
+#define RICE_MAX_PARAM          24U     // Maximum Rice parameter
+
+// LZ hash table (used by encoder only, encoder is not reentrant)
+static uint16_t LzTable[1U << SDS_CODEC_LZ_HASH_BITS];
+
+// Load little endian value
+static uint32_t LoadValue (const uint8_t *p, uint32_t size) {
+  uint32_t val = 0U;
+  uint32_t n;
+
+  for (n = 0U; n < size; n++) {
+    val |= (uint32_t)p[n] << (8U * n);
+  }
+  return val;
+}
+
+// Store little endian value
+static void StoreValue (uint8_t *p, uint32_t val, uint32_t size) {
+  uint32_t n;
+
+  for (n = 0U; n < size; n++) {
+    p[n] = (uint8_t)(val >> (8U * n));
+  }
+}
+
+// Delta encode: per channel delta (modulo sample width), zigzag and bit-packing in groups
+//   group: bit width (1 byte), residuals packed LSB first (padded to byte boundary)
+static uint32_t DeltaEncode (uint32_t sample_size, uint32_t channels,
+                             const uint8_t *in, uint32_t in_size, uint8_t *out, uint32_t out_size) {
+  uint32_t prev[SDS_CODEC_MAX_CHANNELS] = {0U};
+  uint32_t group[DELTA_GROUP_SIZE];
+  uint32_t shift = 32U - (8U * sample_size);
+  uint32_t num   = in_size / sample_size;
+  uint32_t ch    = 0U;
+  uint32_t pos   = 0U;
+  uint32_t i, n, cnt, val, max, width, acc_bits;
+  uint64_t acc;
+  int32_t  delta;
+
+  for (i = 0U; i < num; i += cnt) {
+    cnt = num - i;
+    if (cnt > DELTA_GROUP_SIZE) {
+      cnt = DELTA_GROUP_SIZE;
+    }
+
+    // Zigzag encoded deltas of group
+    max = 0U;
+    for (n = 0U; n < cnt; n++) {
+      val   = LoadValue(&in[(i + n) * sample_size], sample_size);
+      delta = (int32_t)((val - prev[ch]) << shift) >> shift;
+      prev[ch] = val;
+      if (++ch == channels) {
+        ch = 0U;
+      }
+      group[n] = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+      max |= group[n];
+    }
+    for (width = 0U; max != 0U; width++) {
+      max >>= 1;
+    }
+
+    if ((pos + 1U + (((cnt * width) + 7U) / 8U)) > out_size) {
+      return 0U;
+    }
+
+    // Bit-packing
+    out[pos++] = (uint8_t)width;
+    acc      = 0U;
+    acc_bits = 0U;
+    for (n = 0U; n < cnt; n++) {
+      acc |= (uint64_t)group[n] << acc_bits;
+      acc_bits += width;
+      while (acc_bits >= 8U) {
+        out[pos++] = (uint8_t)acc;
+        acc >>= 8;
+        acc_bits -= 8U;
+      }
+    }
+    if (acc_bits != 0U) {
+      out[pos++] = (uint8_t)acc;
+    }
+  }
+
+  return pos;
+}
+
+// Delta decode
+static uint32_t DeltaDecode (uint32_t sample_size, uint32_t channels,
+                             const uint8_t *in, uint32_t in_size, uint8_t *out, uint32_t out_size) {
+  uint32_t prev[SDS_CODEC_MAX_CHANNELS] = {0U};
+  uint32_t num   = out_size / sample_size;
+  uint32_t ch    = 0U;
+  uint32_t pos   = 0U;
+  uint32_t i, n, cnt, val, width, mask, acc_bits;
+  uint64_t acc;
+
+  for (i = 0U; i < num; i += cnt) {
+    cnt = num - i;
+    if (cnt > DELTA_GROUP_SIZE) {
+      cnt = DELTA_GROUP_SIZE;
+    }
+    if (pos >= in_size) {
+      return 0U;
+    }
+    width = in[pos++];
+    if ((width > (8U * sample_size)) || ((pos + (((cnt * width) + 7U) / 8U)) > in_size)) {
+      return 0U;
+    }
+    mask = (width == 32U) ? 0xFFFFFFFFU : ((1U << width) - 1U);
+
+    acc      = 0U;
+    acc_bits = 0U;
+    for (n = 0U; n < cnt; n++) {
+      while (acc_bits < width) {
+        acc |= (uint64_t)in[pos++] << acc_bits;
+        acc_bits += 8U;
+      }
+      val = (uint32_t)acc & mask;
+      acc >>= width;
+      acc_bits -= width;
+      val = prev[ch] + ((val >> 1) ^ (0U - (val & 1U)));
+      prev[ch] = val;
+      if (++ch == channels) {
+        ch = 0U;
+      }
+      StoreValue(&out[(i + n) * sample_size], val, sample_size);
+    }
+  }
+
+  return (pos == in_size) ? (num * sample_size) : 0U;
+}
+
+// LZ hash of 4 bytes
+static uint32_t LzHash (const uint8_t *p) {
+  uint32_t val;
+
+  memcpy(&val, p, 4U);
+  return (val * 2654435761U) >> (32U - SDS_CODEC_LZ_HASH_BITS);
+}
+
+// LZ length extension (for lengths of 15 and above)
+static uint32_t LzLength (uint8_t *out, uint32_t pos, uint32_t len) {
+  while (len >= 255U) {
+    out[pos++] = 255U;
+    len -= 255U;
+  }
+  out[pos++] = (uint8_t)len;
+  return pos;
+}
+
+// LZ sequence: token, literals and match (match_len = 0 for last sequence)
+static uint32_t LzSequence (uint8_t *out, uint32_t pos, uint32_t out_size,
+                            const uint8_t *lit, uint32_t lit_len, uint32_t offset, uint32_t match_len) {
+  uint32_t ml = (match_len != 0U) ? (match_len - LZ_MIN_MATCH) : 0U;
+
+  if ((pos + 1U + ((lit_len / 255U) + 1U) + lit_len + 2U + ((ml / 255U) + 1U)) > out_size) {
+    return 0U;
+  }
+
+  out[pos++] = (uint8_t)(((lit_len >= 15U) ? 0xF0U : (lit_len << 4)) | ((ml >= 15U) ? 0x0FU : ml));
+  if (lit_len >= 15U) {
+    pos = LzLength(out, pos, lit_len - 15U);
+  }
+  memcpy(&out[pos], lit, lit_len);
+  pos += lit_len;
+
+  if (match_len != 0U) {
+    out[pos++] = (uint8_t)offset;
+    out[pos++] = (uint8_t)(offset >> 8);
+    if (ml >= 15U) {
+      pos = LzLength(out, pos, ml - 15U);
+    }
+  }
+
+  return pos;
+}
+
+// LZ encode (greedy, single hash table probe)
+static uint32_t LzEncode (const uint8_t *in, uint32_t in_size, uint8_t *out, uint32_t out_size) {
+  uint32_t ip     = 0U;
+  uint32_t anchor = 0U;
+  uint32_t pos    = 0U;
+  uint32_t h, ref, len;
+
+  if (in_size > LZ_MAX_INPUT) {
+    return 0U;
+  }
+  memset(LzTable, 0, sizeof(LzTable));
+
+  while ((ip + LZ_MF_LIMIT) < in_size) {
+    h   = LzHash(&in[ip]);
+    ref = LzTable[h];
+    LzTable[h] = (uint16_t)ip;
+    if ((ref < ip) && (memcmp(&in[ref], &in[ip], LZ_MIN_MATCH) == 0)) {
+      len = LZ_MIN_MATCH;
+      while (((ip + len) < (in_size - LZ_LAST_LITERALS)) && (in[ref + len] == in[ip + len])) {
+        len++;
+      }
+      pos = LzSequence(out, pos, out_size, &in[anchor], ip - anchor, ip - ref, len);
+      if (pos == 0U) {
+        return 0U;
+      }
+      ip    += len;
+      anchor = ip;
+    } else {
+      ip++;
+    }
+  }
+
+  // Last literals
+  return LzSequence(out, pos, out_size, &in[anchor], in_size - anchor, 0U, 0U);
+}
+
+// LZ length extension decode
+static uint32_t LzLengthDecode (const uint8_t *in, uint32_t *pos, uint32_t in_size, uint32_t len) {
+  uint8_t val;
+
+  do {
+    if (*pos >= in_size) {
+      return 0xFFFFFFFFU;
+    }
+    val  = in[(*pos)++];
+    len += val;
+  } while (val == 255U);
+
+  return len;
+}
+
+// LZ decode
+static uint32_t LzDecode (const uint8_t *in, uint32_t in_size, uint8_t *out, uint32_t out_size) {
+  uint32_t pos = 0U;
+  uint32_t op  = 0U;
+  uint32_t token, len, offset;
+
+  while (pos < in_size) {
+    token = in[pos++];
+
+    // Literals
+    len = token >> 4;
+    if (len == 15U) {
+      len = LzLengthDecode(in, &pos, in_size, len);
+    }
+    if ((len > (in_size - pos)) || (len > (out_size - op))) {
+      return 0U;
+    }
+    memcpy(&out[op], &in[pos], len);
+    pos += len;
+    op  += len;
+    if (pos == in_size) {
+      break;
+    }
+
+    // Match (may overlap with output)
+    if ((pos + 2U) > in_size) {
+      return 0U;
+    }
+    offset = (uint32_t)in[pos] | ((uint32_t)in[pos + 1U] << 8);
+    pos += 2U;
+    len = token & 0x0FU;
+    if (len == 15U) {
+      len = LzLengthDecode(in, &pos, in_size, len);
+    }
+    if ((offset == 0U) || (offset > op) ||
+        ((out_size - op) < LZ_MIN_MATCH) || (len > (out_size - op - LZ_MIN_MATCH))) {
+      return 0U;
+    }
+    for (len += LZ_MIN_MATCH; len != 0U; len--) {
+      out[op] = out[op - offset];
+      op++;
+    }
+  }
+
+  return op;
+}
+
+// Bit-stream writer (MSB first)
+typedef struct {
+  uint8_t *buf;
+  uint32_t size;
+  uint32_t pos;
+  uint32_t acc;
+  uint32_t bits;
+  uint32_t error;
+} BitWriter_t;
+
+// Bit-stream reader (MSB first)
+typedef struct {
+  const uint8_t *buf;
+  uint32_t size;
+  uint32_t pos;
+  uint32_t acc;
+  uint32_t bits;
+  uint32_t error;
+} BitReader_t;
+
+// Write bits (up to 24)
+static void BitPut (BitWriter_t *bw, uint32_t val, uint32_t bits) {
+  bw->acc   = (bw->acc << bits) | (val & ((1U << bits) - 1U));
+  bw->bits += bits;
+  while (bw->bits >= 8U) {
+    bw->bits -= 8U;
+    if (bw->pos < bw->size) {
+      bw->buf[bw->pos++] = (uint8_t)(bw->acc >> bw->bits);
+    } else {
+      bw->error = 1U;
+    }
+  }
+}
+
+// Read bits (up to 24)
+static uint32_t BitGet (BitReader_t *br, uint32_t bits) {
+  while (br->bits < bits) {
+    br->acc <<= 8;
+    if (br->pos < br->size) {
+      br->acc |= br->buf[br->pos++];
+    } else {
+      br->error = 1U;
+    }
+    br->bits += 8U;
+  }
+  br->bits -= bits;
+  return (br->acc >> br->bits) & ((1U << bits) - 1U);
+}
+
+// Load 16-bit sample of channel
+static int32_t RiceSample (const uint8_t *buf, uint32_t channels, uint32_t ch, uint32_t i) {
+  return (int16_t)LoadValue(&buf[((i * channels) + ch) * 2U], 2U);
+}
+
+// Fixed predictor residuals of orders 0..4 (d[k] is valid for sample index >= k)
+static void RiceResiduals (int32_t *d, int32_t x) {
+  int32_t prev, k;
+
+  prev = d[0];
+  d[0] = x;
+  for (k = 1; k <= (int32_t)RICE_MAX_ORDER; k++) {
+    x    = d[k - 1] - prev;
+    prev = d[k];
+    d[k] = x;
+  }
+}
+
+// Rice encode: per channel fixed predictor (order with smallest residuals),
+//   order (3 bits), warm-up samples (16 bits each), partitions of residuals:
+//   Rice parameter (5 bits), zigzag residuals Rice coded (unary quotient, parameter bits remainder)
+static uint32_t RiceEncode (uint32_t channels, const uint8_t *in, uint32_t in_size, uint8_t *out, uint32_t out_size) {
+  BitWriter_t bw = { out, out_size, 0U, 0U, 0U, 0U };
+  uint32_t    res[RICE_PARTITION_SIZE];
+  uint64_t    sum[RICE_MAX_ORDER + 1U];
+  int32_t     d[RICE_MAX_ORDER + 1U];
+  uint32_t    num = in_size / (2U * channels);
+  uint32_t    ch, i, n, k, cnt, order, q;
+  uint64_t    total;
+
+  for (ch = 0U; ch < channels; ch++) {
+
+    // Select predictor order
+    memset(d,   0, sizeof(d));
+    memset(sum, 0, sizeof(sum));
+    for (i = 0U; i < num; i++) {
+      RiceResiduals(d, RiceSample(in, channels, ch, i));
+      if (i >= RICE_MAX_ORDER) {
+        for (k = 0U; k <= RICE_MAX_ORDER; k++) {
+          sum[k] += (uint32_t)((d[k] < 0) ? -d[k] : d[k]);
+        }
+      }
+    }
+    order = 0U;
+    for (k = 1U; k <= RICE_MAX_ORDER; k++) {
+      if (sum[k] < sum[order]) {
+        order = k;
+      }
+    }
+    if (order > num) {
+      order = num;
+    }
+
+    // Predictor order and warm-up samples
+    BitPut(&bw, order, 3U);
+    for (i = 0U; i < order; i++) {
+      BitPut(&bw, (uint32_t)RiceSample(in, channels, ch, i), 16U);
+    }
+
+    // Residual partitions
+    memset(d, 0, sizeof(d));
+    for (i = 0U; i < order; i++) {
+      RiceResiduals(d, RiceSample(in, channels, ch, i));
+    }
+    while (i < num) {
+      cnt   = 0U;
+      total = 0U;
+      for (; (i < num) && (cnt < RICE_PARTITION_SIZE); i++) {
+        RiceResiduals(d, RiceSample(in, channels, ch, i));
+        res[cnt] = ((uint32_t)d[order] << 1) ^ (uint32_t)(d[order] >> 31);
+        total   += res[cnt++];
+      }
+      for (k = 0U; (k < RICE_MAX_PARAM) && (((uint64_t)cnt << (k + 1U)) < total); k++);
+      BitPut(&bw, k, RICE_PARAM_BITS);
+      for (n = 0U; n < cnt; n++) {
+        for (q = res[n] >> k; q >= 16U; q -= 16U) {
+          BitPut(&bw, 0U, 16U);
+        }
+        BitPut(&bw, 1U, q + 1U);
+        BitPut(&bw, res[n], k);
+      }
+      if (bw.error != 0U) {
+        return 0U;
+      }
+    }
+  }
+
+  // Pad to byte boundary
+  if (bw.bits != 0U) {
+    BitPut(&bw, 0U, 8U - bw.bits);
+  }
+
+  return (bw.error == 0U) ? bw.pos : 0U;
+}
+
+// Rice decode
+static uint32_t RiceDecode (uint32_t channels, const uint8_t *in, uint32_t in_size, uint8_t *out, uint32_t out_size) {
+  BitReader_t br = { in, in_size, 0U, 0U, 0U, 0U };
+  uint32_t    num = out_size / (2U * channels);
+  uint32_t    ch, i, k, cnt, order, q, val;
+  int32_t     x, x1, x2, x3, x4;
+
+  for (ch = 0U; ch < channels; ch++) {
+    order = BitGet(&br, 3U);
+    if ((order > RICE_MAX_ORDER) || (order > num)) {
+      return 0U;
+    }
+    for (i = 0U; i < order; i++) {
+      StoreValue(&out[((i * channels) + ch) * 2U], BitGet(&br, 16U), 2U);
+    }
+
+    while (i < num) {
+      k = BitGet(&br, RICE_PARAM_BITS);
+      if (k > RICE_MAX_PARAM) {
+        return 0U;
+      }
+      for (cnt = 0U; (i < num) && (cnt < RICE_PARTITION_SIZE); cnt++, i++) {
+        for (q = 0U; BitGet(&br, 1U) == 0U; q++) {
+          if (br.error != 0U) {
+            return 0U;
+          }
+        }
+        val = (q << k) | BitGet(&br, k);
+        x   = (int32_t)((val >> 1) ^ (0U - (val & 1U)));
+        x1  = (order > 0U) ? RiceSample(out, channels, ch, i - 1U) : 0;
+        x2  = (order > 1U) ? RiceSample(out, channels, ch, i - 2U) : 0;
+        x3  = (order > 2U) ? RiceSample(out, channels, ch, i - 3U) : 0;
+        x4  = (order > 3U) ? RiceSample(out, channels, ch, i - 4U) : 0;
+        switch (order) {
+          case 1U: x += x1;                                 break;
+          case 2U: x += (2 * x1) - x2;                      break;
+          case 3U: x += (3 * x1) - (3 * x2) + x3;           break;
+          case 4U: x += (4 * x1) - (6 * x2) + (4 * x3) - x4; break;
+          default:                                          break;
+        }
+        StoreValue(&out[((i * channels) + ch) * 2U], (uint32_t)x, 2U);
+      }
+    }
+  }
+
+  return (br.error == 0U) ? (num * 2U * channels) : 0U;
+}
+
+// Encode data block
+uint32_t sdsCodecEncode (uint32_t codec, uint32_t sample_size, uint32_t channels,
+                         const void *in, uint32_t in_size, void *out, uint32_t out_size) {
+  uint8_t *p   = out;
+  uint32_t num = 0U;
+
+  if ((in == NULL) || (out == NULL) || (in_size == 0U) || (out_size <= SDS_CODEC_HEADER_SIZE)) {
+    return 0U;
+  }
+
+  switch (codec) {
+    case SDS_CODEC_DELTA:
+      if (((sample_size == 1U) || (sample_size == 2U) || (sample_size == 4U)) &&
+          (channels != 0U) && (channels <= SDS_CODEC_MAX_CHANNELS) && ((in_size % sample_size) == 0U)) {
+        num = DeltaEncode(sample_size, channels, in, in_size,
+                          p + SDS_CODEC_HEADER_SIZE, out_size - SDS_CODEC_HEADER_SIZE);
+      }
+      break;
+    case SDS_CODEC_LZ:
+      sample_size = 1U;
+      channels    = 1U;
+      num = LzEncode(in, in_size, p + SDS_CODEC_HEADER_SIZE, out_size - SDS_CODEC_HEADER_SIZE);
+      break;
+    case SDS_CODEC_RICE:
+      if ((sample_size == 2U) && (channels != 0U) && (channels <= SDS_CODEC_MAX_CHANNELS) &&
+          ((in_size % (2U * channels)) == 0U)) {
+        num = RiceEncode(channels, in, in_size, p + SDS_CODEC_HEADER_SIZE, out_size - SDS_CODEC_HEADER_SIZE);
+      }
+      break;
+    default:
+      break;
+  }
+
+  if (num != 0U) {
+    p[0] = (uint8_t)codec;
+    p[1] = (uint8_t)sample_size;
+    p[2] = (uint8_t)channels;
+    p[3] = 0U;
+    StoreValue(&p[4], in_size, 4U);
+    num += SDS_CODEC_HEADER_SIZE;
+  }
+
+  return num;
+}
+
+// Decode data block
+uint32_t sdsCodecDecode (const void *in, uint32_t in_size, void *out, uint32_t out_size) {
+  const uint8_t *p = in;
+  uint32_t sample_size, channels, size;
+  uint32_t num = 0U;
+
+  if ((in == NULL) || (out == NULL) || (in_size < SDS_CODEC_HEADER_SIZE)) {
+    return 0U;
+  }
+
+  sample_size = p[1];
+  channels    = p[2];
+  size        = LoadValue(&p[4], 4U);
+  if (size > out_size) {
+    return 0U;
+  }
+
+  switch (p[0]) {
+    case SDS_CODEC_DELTA:
+      if (((sample_size == 1U) || (sample_size == 2U) || (sample_size == 4U)) &&
+          (channels != 0U) && (channels <= SDS_CODEC_MAX_CHANNELS) && ((size % sample_size) == 0U)) {
+        num = DeltaDecode(sample_size, channels, p + SDS_CODEC_HEADER_SIZE, in_size - SDS_CODEC_HEADER_SIZE, out, size);
+      }
+      break;
+    case SDS_CODEC_LZ:
+      num = LzDecode(p + SDS_CODEC_HEADER_SIZE, in_size - SDS_CODEC_HEADER_SIZE, out, size);
+      break;
+    case SDS_CODEC_RICE:
+      if ((sample_size == 2U) && (channels != 0U) && (channels <= SDS_CODEC_MAX_CHANNELS) &&
+          ((size % (2U * channels)) == 0U)) {
+        num = RiceDecode(channels, p + SDS_CODEC_HEADER_SIZE, in_size - SDS_CODEC_HEADER_SIZE, out, size);
+      }
+      break;
+    default:
+      break;
+  }
+
+  return (num == size) ? num : 0U;
+}
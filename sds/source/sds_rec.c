@@ -19,6 +19,7 @@
 // SDS Recorder
 
 #include <stdatomic.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "cmsis_compiler.h"
@@ -34,6 +35,15 @@
 #ifndef SDS_REC_MAX_RECORD_SIZE
 #define SDS_REC_MAX_RECORD_SIZE 8192U
 #endif
+#ifndef SDS_REC_IO_BUF_NUM
+#define SDS_REC_IO_BUF_NUM      2U
+#endif
+#ifndef SDS_REC_CODEC
+#define SDS_REC_CODEC           0       // Record compression (0: disabled, 1: enabled)
+#endif
+#ifndef SDS_REC_EXT_HEADER
+#define SDS_REC_EXT_HEADER      0       // Extended record header with sync, sequence and CRC (0: disabled, 1: enabled)
+#endif
 
 #if SDS_REC_MAX_STREAMS > 31
 #error "Maximmum number of SDS Recorder streams is 31!"
@@ -47,6 +57,12 @@ typedef struct {
            sdsioId_t   sdsio;
   volatile uint32_t    cnt_in;
   volatile uint32_t    cnt_out;
+           uint32_t    io_lost;
+           uint32_t    sequence;
+           uint8_t     codec;
+           uint8_t     sample_size;
+           uint8_t     channels;
+           uint8_t     reserved;
 } sdsRec_t;
 
 static sdsRec_t   RecStreams[SDS_REC_MAX_STREAMS] = {0};
@@ -58,8 +74,88 @@ typedef struct {
   uint32_t    data_size;        // Data size in bytes
 } RecHead_t;
 
-// Record buffer
-static uint8_t RecBuf[SDS_REC_MAX_RECORD_SIZE];
+// Record data size flags
+#define REC_SIZE_ENCODED        (1UL << 31)     // Data is encoded (codec header followed by encoded data)
+#define REC_SIZE_TS64           (1UL << 30)     // Timestamp high word follows record header
+#define REC_SIZE_MASK           (REC_SIZE_TS64 - 1U)
+
+// Size of record header extension (timestamp high word)
+#define REC_HEAD_EXT_SIZE(data_size) ((((data_size) & REC_SIZE_TS64) != 0U) ? sizeof(uint32_t) : 0U)
+
+#if (SDS_REC_EXT_HEADER != 0)
+// Extended record header (written to output device)
+typedef struct {
+  uint32_t    sync;             // Sync word
+  uint32_t    sequence;         // Record sequence number
+  uint32_t    timestamp;        // Timestamp in ticks
+  uint32_t    data_size;        // Data size in bytes
+  uint32_t    crc;              // CRC32C of header (without CRC) and data
+} RecOutHead_t;
+
+#define REC_SYNC                0x52534453U     // "SDSR"
+
+// CRC32C (Castagnoli) lookup table (reflected polynomial 0x82F63B78)
+static const uint32_t RecCrcTable[256] = {
+  0x00000000U, 0xF26B8303U, 0xE13B70F7U, 0x1350F3F4U, 0xC79A971FU, 0x35F1141CU,
+  0x26A1E7E8U, 0xD4CA64EBU, 0x8AD958CFU, 0x78B2DBCCU, 0x6BE22838U, 0x9989AB3BU,
+  0x4D43CFD0U, 0xBF284CD3U, 0xAC78BF27U, 0x5E133C24U, 0x105EC76FU, 0xE235446CU,
+  0xF165B798U, 0x030E349BU, 0xD7C45070U, 0x25AFD373U, 0x36FF2087U, 0xC494A384U,
+  0x9A879FA0U, 0x68EC1CA3U, 0x7BBCEF57U, 0x89D76C54U, 0x5D1D08BFU, 0xAF768BBCU,
+  0xBC267848U, 0x4E4DFB4BU, 0x20BD8EDEU, 0xD2D60DDDU, 0xC186FE29U, 0x33ED7D2AU,
+  0xE72719C1U, 0x154C9AC2U, 0x061C6936U, 0xF477EA35U, 0xAA64D611U, 0x580F5512U,
+  0x4B5FA6E6U, 0xB93425E5U, 0x6DFE410EU, 0x9F95C20DU, 0x8CC531F9U, 0x7EAEB2FAU,
+  0x30E349B1U, 0xC288CAB2U, 0xD1D83946U, 0x23B3BA45U, 0xF779DEAEU, 0x05125DADU,
+  0x1642AE59U, 0xE4292D5AU, 0xBA3A117EU, 0x4851927DU, 0x5B016189U, 0xA96AE28AU,
+  0x7DA08661U, 0x8FCB0562U, 0x9C9BF696U, 0x6EF07595U, 0x417B1DBCU, 0xB3109EBFU,
+  0xA0406D4BU, 0x522BEE48U, 0x86E18AA3U, 0x748A09A0U, 0x67DAFA54U, 0x95B17957U,
+  0xCBA24573U, 0x39C9C670U, 0x2A993584U, 0xD8F2B687U, 0x0C38D26CU, 0xFE53516FU,
+  0xED03A29BU, 0x1F682198U, 0x5125DAD3U, 0xA34E59D0U, 0xB01EAA24U, 0x42752927U,
+  0x96BF4DCCU, 0x64D4CECFU, 0x77843D3BU, 0x85EFBE38U, 0xDBFC821CU, 0x2997011FU,
+  0x3AC7F2EBU, 0xC8AC71E8U, 0x1C661503U, 0xEE0D9600U, 0xFD5D65F4U, 0x0F36E6F7U,
+  0x61C69362U, 0x93AD1061U, 0x80FDE395U, 0x72966096U, 0xA65C047DU, 0x5437877EU,
+  0x4767748AU, 0xB50CF789U, 0xEB1FCBADU, 0x197448AEU, 0x0A24BB5AU, 0xF84F3859U,
+  0x2C855CB2U, 0xDEEEDFB1U, 0xCDBE2C45U, 0x3FD5AF46U, 0x7198540DU, 0x83F3D70EU,
+  0x90A324FAU, 0x62C8A7F9U, 0xB602C312U, 0x44694011U, 0x5739B3E5U, 0xA55230E6U,
+  0xFB410CC2U, 0x092A8FC1U, 0x1A7A7C35U, 0xE811FF36U, 0x3CDB9BDDU, 0xCEB018DEU,
+  0xDDE0EB2AU, 0x2F8B6829U, 0x82F63B78U, 0x709DB87BU, 0x63CD4B8FU, 0x91A6C88CU,
+  0x456CAC67U, 0xB7072F64U, 0xA457DC90U, 0x563C5F93U, 0x082F63B7U, 0xFA44E0B4U,
+  0xE9141340U, 0x1B7F9043U, 0xCFB5F4A8U, 0x3DDE77ABU, 0x2E8E845FU, 0xDCE5075CU,
+  0x92A8FC17U, 0x60C37F14U, 0x73938CE0U, 0x81F80FE3U, 0x55326B08U, 0xA759E80BU,
+  0xB4091BFFU, 0x466298FCU, 0x1871A4D8U, 0xEA1A27DBU, 0xF94AD42FU, 0x0B21572CU,
+  0xDFEB33C7U, 0x2D80B0C4U, 0x3ED04330U, 0xCCBBC033U, 0xA24BB5A6U, 0x502036A5U,
+  0x4370C551U, 0xB11B4652U, 0x65D122B9U, 0x97BAA1BAU, 0x84EA524EU, 0x7681D14DU,
+  0x2892ED69U, 0xDAF96E6AU, 0xC9A99D9EU, 0x3BC21E9DU, 0xEF087A76U, 0x1D63F975U,
+  0x0E330A81U, 0xFC588982U, 0xB21572C9U, 0x407EF1CAU, 0x532E023EU, 0xA145813DU,
+  0x758FE5D6U, 0x87E466D5U, 0x94B49521U, 0x66DF1622U, 0x38CC2A06U, 0xCAA7A905U,
+  0xD9F75AF1U, 0x2B9CD9F2U, 0xFF56BD19U, 0x0D3D3E1AU, 0x1E6DCDEEU, 0xEC064EEDU,
+  0xC38D26C4U, 0x31E6A5C7U, 0x22B65633U, 0xD0DDD530U, 0x0417B1DBU, 0xF67C32D8U,
+  0xE52CC12CU, 0x1747422FU, 0x49547E0BU, 0xBB3FFD08U, 0xA86F0EFCU, 0x5A048DFFU,
+  0x8ECEE914U, 0x7CA56A17U, 0x6FF599E3U, 0x9D9E1AE0U, 0xD3D3E1ABU, 0x21B862A8U,
+  0x32E8915CU, 0xC083125FU, 0x144976B4U, 0xE622F5B7U, 0xF5720643U, 0x07198540U,
+  0x590AB964U, 0xAB613A67U, 0xB831C993U, 0x4A5A4A90U, 0x9E902E7BU, 0x6CFBAD78U,
+  0x7FAB5E8CU, 0x8DC0DD8FU, 0xE330A81AU, 0x115B2B19U, 0x020BD8EDU, 0xF0605BEEU,
+  0x24AA3F05U, 0xD6C1BC06U, 0xC5914FF2U, 0x37FACCF1U, 0x69E9F0D5U, 0x9B8273D6U,
+  0x88D28022U, 0x7AB90321U, 0xAE7367CAU, 0x5C18E4C9U, 0x4F48173DU, 0xBD23943EU,
+  0xF36E6F75U, 0x0105EC76U, 0x12551F82U, 0xE03E9C81U, 0x34F4F86AU, 0xC69F7B69U,
+  0xD5CF889DU, 0x27A40B9EU, 0x79B737BAU, 0x8BDCB4B9U, 0x988C474DU, 0x6AE7C44EU,
+  0xBE2DA0A5U, 0x4C4623A6U, 0x5F16D052U, 0xAD7D5351U
+};
+#else
+// Record header (written to output device)
+typedef RecHead_t RecOutHead_t;
+#endif
+
+// Record buffers (written asynchronously while next record is prepared):
+// output record header, timestamp high word (optional) and data
+static uint8_t  RecBuf[SDS_REC_IO_BUF_NUM][SDS_REC_MAX_RECORD_SIZE - sizeof(RecHead_t) + sizeof(RecOutHead_t) + sizeof(uint32_t)];
+
+// Free record buffers queue (writes of different streams may complete in any order)
+static osMessageQueueId_t sdsRecBufQueue;
+
+#if (SDS_REC_CODEC != 0)
+// Raw record data buffer (input of encoder)
+static uint8_t  RecCodecBuf[SDS_REC_MAX_RECORD_SIZE];
+#endif
 
 // Event callback
 static sdsRecEvent_t sdsRecEvent = NULL;
@@ -136,6 +232,20 @@ static void sdsRecFree (uint32_t index) {
   pRecStreams[index] = NULL;
 }
 
+#if (SDS_REC_EXT_HEADER != 0)
+// CRC32C calculation (table driven, may be overridden by hardware CRC implementation)
+//   crc: CRC of preceding data (0 for first block)
+__WEAK uint32_t sdsRecCrc32c (uint32_t crc, const uint8_t *buf, uint32_t len) {
+  uint32_t n;
+
+  crc = ~crc;
+  for (n = 0U; n < len; n++) {
+    crc = RecCrcTable[(crc ^ buf[n]) & 0xFFU] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+#endif
+
 // Event callback
 static void sdsRecEventCallback (sdsId_t id, uint32_t event, void *arg) {
   uint32_t flags = (uint32_t)arg;
@@ -145,10 +255,101 @@ static void sdsRecEventCallback (sdsId_t id, uint32_t event, void *arg) {
   osThreadFlagsSet(sdsRecThreadId, flags);
 }
 
+// I/O write completion callback (called from I/O thread)
+static void sdsRecWriteDone (sdsioId_t id, const void *buf, uint32_t num, void *arg) {
+  sdsRec_t    *rec = arg;
+  RecOutHead_t rec_head;
+  sdsioInfo_t  info;
+
+  memcpy(&rec_head, buf, sizeof(RecOutHead_t));
+  if (num != (sizeof(RecOutHead_t) + REC_HEAD_EXT_SIZE(rec_head.data_size) + (rec_head.data_size & REC_SIZE_MASK))) {
+    if (sdsRecEvent != NULL) {
+      sdsRecEvent(rec, SDS_REC_EVENT_IO_ERROR);
+    }
+  }
+  if ((sdsioGetInfo(id, &info) == SDSIO_OK) && (info.bytes_lost != rec->io_lost)) {
+    rec->io_lost = info.bytes_lost;
+    if ((info.bytes_lost != 0U) && (sdsRecEvent != NULL)) {
+      sdsRecEvent(rec, SDS_REC_EVENT_DATA_LOST);
+    }
+  }
+  osMessageQueuePut(sdsRecBufQueue, &buf, 0U, 0U);
+}
+
+// Wait until all submitted record writes are completed
+static void sdsRecWriteFlush (void) {
+  uint8_t *buf[SDS_REC_IO_BUF_NUM];
+  uint32_t n;
+
+  for (n = 0U; n < SDS_REC_IO_BUF_NUM; n++) {
+    osMessageQueueGet(sdsRecBufQueue, &buf[n], NULL, osWaitForever);
+  }
+  for (n = 0U; n < SDS_REC_IO_BUF_NUM; n++) {
+    osMessageQueuePut(sdsRecBufQueue, &buf[n], 0U, 0U);
+  }
+}
+
+// Read record from SDS buffer into record buffer: timestamp high word (optional) and
+// data (encoded when smaller than raw data)
+static int32_t sdsRecReadData (sdsRec_t *rec, RecHead_t *rec_head, uint8_t *buf) {
+  uint32_t size = rec_head->data_size & REC_SIZE_MASK;
+  uint32_t ext  = REC_HEAD_EXT_SIZE(rec_head->data_size);
+#if (SDS_REC_CODEC != 0)
+  uint32_t num;
+#endif
+
+  if ((ext != 0U) && (sdsRead(rec->stream, buf, ext) != ext)) {
+    return SDS_REC_ERROR;
+  }
+  buf += ext;
+
+#if (SDS_REC_CODEC != 0)
+  if ((rec->codec != SDS_CODEC_NONE) && (size > SDS_CODEC_HEADER_SIZE)) {
+    if (sdsRead(rec->stream, RecCodecBuf, size) != size) {
+      return SDS_REC_ERROR;
+    }
+    num = sdsCodecEncode(rec->codec, rec->sample_size, rec->channels, RecCodecBuf, size, buf, size - 1U);
+    if (num != 0U) {
+      rec_head->data_size = num | REC_SIZE_ENCODED | (rec_head->data_size & REC_SIZE_TS64);
+    } else {
+      memcpy(buf, RecCodecBuf, size);
+    }
+    return SDS_REC_OK;
+  }
+#else
+  (void)rec;
+#endif
+
+  return (sdsRead(rec->stream, buf, size) == size) ? SDS_REC_OK : SDS_REC_ERROR;
+}
+
+// Prepare output record header in front of record (timestamp high word and data)
+static uint32_t sdsRecOutHeader (sdsRec_t *rec, const RecHead_t *rec_head, uint8_t *buf) {
+  RecOutHead_t out_head;
+  uint32_t     size = REC_HEAD_EXT_SIZE(rec_head->data_size) + (rec_head->data_size & REC_SIZE_MASK);
+
+#if (SDS_REC_EXT_HEADER != 0)
+  out_head.sync      = REC_SYNC;
+  out_head.sequence  = rec->sequence;
+  out_head.timestamp = rec_head->timestamp;
+  out_head.data_size = rec_head->data_size;
+  out_head.crc       = sdsRecCrc32c(0U, (const uint8_t *)&out_head, offsetof(RecOutHead_t, crc));
+  out_head.crc       = sdsRecCrc32c(out_head.crc, buf + sizeof(RecOutHead_t), size);
+#else
+  out_head = *rec_head;
+#endif
+  memcpy(buf, &out_head, sizeof(RecOutHead_t));
+  rec->sequence++;
+
+  return sizeof(RecOutHead_t) + size;
+}
+
 // Recorder thread
 static __NO_RETURN void sdsRecThread (void *arg) {
   sdsRec_t *rec;
   uint32_t mask, flags, fm, cnt, n;
+  int32_t   status;
+  uint8_t  *buf;
   RecHead_t rec_head;
 
   (void)arg;
@@ -172,20 +373,22 @@ static __NO_RETURN void sdsRecThread (void *arg) {
         while (rec->cnt_out != rec->cnt_in) {
           cnt = sdsRead(rec->stream, &rec_head, sizeof(RecHead_t));
           if (cnt == sizeof(RecHead_t)) {
-            memcpy(RecBuf, &rec_head, sizeof(RecHead_t));
-            cnt = sdsRead(rec->stream, RecBuf + sizeof(RecHead_t), rec_head.data_size);
+            osMessageQueueGet(sdsRecBufQueue, &buf, NULL, osWaitForever);
+            status = sdsRecReadData(rec, &rec_head, buf + sizeof(RecOutHead_t));
+            cnt = sdsRecOutHeader(rec, &rec_head, buf);
             rec->cnt_out++;
-            if (cnt == rec_head.data_size) {
-              cnt += sizeof(RecHead_t);
-              if (sdsioWrite(rec->sdsio, RecBuf, cnt) != cnt) {
-                if (sdsRecEvent != NULL) {
-                  sdsRecEvent(rec, SDS_REC_EVENT_IO_ERROR);
-                }
+            // Buffer is returned to the free buffers queue by the write completion callback
+            if ((status != SDS_REC_OK) ||
+                (sdsioWriteAsync(rec->sdsio, buf, cnt, sdsRecWriteDone, rec) != SDSIO_OK)) {
+              osMessageQueuePut(sdsRecBufQueue, &buf, 0U, 0U);
+              if ((status == SDS_REC_OK) && (sdsRecEvent != NULL)) {
+                sdsRecEvent(rec, SDS_REC_EVENT_IO_ERROR);
               }
             }
           }
         }
         if ((fm & FLAG_MASK_CLOSE) != 0U) {
+          sdsRecWriteFlush();
           rec->flag_mask = FLAG_MASK_CLOSE;
           osEventFlagsSet(sdsRecCloseEventFlags, mask);
         }
@@ -198,17 +401,26 @@ static __NO_RETURN void sdsRecThread (void *arg) {
 
 // Initialize recorder
 int32_t sdsRecInit (sdsRecEvent_t event_cb) {
-  int32_t ret = SDS_REC_ERROR;
+  uint8_t *buf;
+  uint32_t n;
+  int32_t  ret = SDS_REC_ERROR;
 
   memset(pRecStreams, 0, sizeof(pRecStreams));
 
   if (sdsioInit() == SDSIO_OK) {
-    sdsRecThreadId = osThreadNew(sdsRecThread, NULL, NULL);
-    if (sdsRecThreadId != NULL)  {
-      sdsRecCloseEventFlags = osEventFlagsNew(NULL);
-      if (sdsRecCloseEventFlags != NULL) {
-        sdsRecEvent = event_cb;
-        ret = SDS_OK;
+    sdsRecBufQueue = osMessageQueueNew(SDS_REC_IO_BUF_NUM, sizeof(uint8_t *), NULL);
+    if (sdsRecBufQueue != NULL) {
+      for (n = 0U; n < SDS_REC_IO_BUF_NUM; n++) {
+        buf = RecBuf[n];
+        osMessageQueuePut(sdsRecBufQueue, &buf, 0U, 0U);
+      }
+      sdsRecThreadId = osThreadNew(sdsRecThread, NULL, NULL);
+      if (sdsRecThreadId != NULL)  {
+        sdsRecCloseEventFlags = osEventFlagsNew(NULL);
+        if (sdsRecCloseEventFlags != NULL) {
+          sdsRecEvent = event_cb;
+          ret = SDS_OK;
+        }
       }
     }
   }
@@ -221,6 +433,7 @@ int32_t sdsRecUninit (void) {
 
   osThreadTerminate(sdsRecThreadId);
   osEventFlagsDelete(sdsRecCloseEventFlags);
+  osMessageQueueDelete(sdsRecBufQueue);
   sdsRecEvent = NULL;
   sdsioUninit();
 
@@ -241,6 +454,9 @@ sdsRecId_t sdsRecOpen (const char *name, void *buf, uint32_t buf_size, uint32_t
       rec->cnt_in    = 0U;
       rec->cnt_out   = 0U;
       rec->flag_mask = 0U;
+      rec->io_lost   = 0U;
+      rec->sequence  = 0U;
+      rec->codec     = SDS_CODEC_NONE;
       rec->stream    = sdsOpen(buf, buf_size, 0U, io_threshold);
       rec->sdsio     = sdsioOpen(name, sdsioModeWrite);
 
@@ -268,6 +484,46 @@ sdsRecId_t sdsRecOpen (const char *name, void *buf, uint32_t buf_size, uint32_t
   return rec;
 }
 
+// Set recorder stream codec
+int32_t sdsRecSetCodec (sdsRecId_t id, uint32_t codec, uint32_t sample_size, uint32_t channels) {
+  sdsRec_t *rec = id;
+  int32_t   ret = SDS_REC_ERROR;
+
+  if (rec != NULL) {
+    switch (codec) {
+      case SDS_CODEC_NONE:
+        ret = SDS_REC_OK;
+        break;
+#if (SDS_REC_CODEC != 0)
+      case SDS_CODEC_DELTA:
+        if (((sample_size == 1U) || (sample_size == 2U) || (sample_size == 4U)) &&
+            (channels != 0U) && (channels <= SDS_CODEC_MAX_CHANNELS)) {
+          ret = SDS_REC_OK;
+        }
+        break;
+      case SDS_CODEC_LZ:
+        sample_size = 1U;
+        channels    = 1U;
+        ret = SDS_REC_OK;
+        break;
+      case SDS_CODEC_RICE:
+        if ((sample_size == 2U) && (channels != 0U) && (channels <= SDS_CODEC_MAX_CHANNELS)) {
+          ret = SDS_REC_OK;
+        }
+        break;
+#endif
+      default:
+        break;
+    }
+    if (ret == SDS_REC_OK) {
+      rec->codec       = (uint8_t)codec;
+      rec->sample_size = (uint8_t)sample_size;
+      rec->channels    = (uint8_t)channels;
+    }
+  }
+  return ret;
+}
+
 // Close recorder stream
 int32_t sdsRecClose (sdsRecId_t id) {
   sdsRec_t *rec = id;
@@ -298,18 +554,21 @@ int32_t sdsRecClose (sdsRecId_t id) {
   return ret;
 }
 
-// Write data to recorder stream
-uint32_t sdsRecWrite (sdsRecId_t id, uint32_t timestamp, const void *buf, uint32_t buf_size) {
+// Write record to recorder stream: timestamp, data size, timestamp high word (optional), data
+static uint32_t sdsRecWriteRecord (sdsRecId_t id, uint64_t timestamp, uint32_t flags, const void *buf, uint32_t buf_size) {
   sdsRec_t *rec = id;
   RecHead_t rec_head;
-  uint32_t num = 0U;
-
-  if ((rec != NULL) && (buf != NULL) && (buf_size != 0U)) {
-    if ((buf_size + sizeof(RecHead_t)) <= (rec->buf_size -  sdsGetCount(rec->stream))) {
-      // Write record to the stream: timestamp, data size, data
-      rec_head.timestamp = timestamp;
-      rec_head.data_size = buf_size;
-      if (sdsWrite(rec->stream, &rec_head, sizeof(RecHead_t)) == sizeof(RecHead_t)) {
+  uint32_t  timestamp_hi = (uint32_t)(timestamp >> 32);
+  uint32_t  ext = REC_HEAD_EXT_SIZE(flags);
+  uint32_t  num = 0U;
+
+  if ((rec != NULL) && (buf != NULL) && (buf_size != 0U) && (buf_size <= REC_SIZE_MASK) &&
+      ((buf_size + sizeof(RecHead_t) + ext) <= SDS_REC_MAX_RECORD_SIZE)) {
+    if ((buf_size + sizeof(RecHead_t) + ext) <= (rec->buf_size -  sdsGetCount(rec->stream))) {
+      rec_head.timestamp = (uint32_t)timestamp;
+      rec_head.data_size = buf_size | flags;
+      if ((sdsWrite(rec->stream, &rec_head, sizeof(RecHead_t)) == sizeof(RecHead_t)) &&
+          ((ext == 0U) || (sdsWrite(rec->stream, &timestamp_hi, ext) == ext))) {
         num = sdsWrite(rec->stream, buf, buf_size);
         rec->cnt_in++;
         if (num == buf_size) {
@@ -322,3 +581,13 @@ uint32_t sdsRecWrite (sdsRecId_t id, uint32_t timestamp, const void *buf, uint32
   }
   return num;
 }
+
+// Write data to recorder stream
+uint32_t sdsRecWrite (sdsRecId_t id, uint32_t timestamp, const void *buf, uint32_t buf_size) {
+  return sdsRecWriteRecord(id, timestamp, 0U, buf, buf_size);
+}
+
+// Write data with 64-bit timestamp to recorder stream
+uint32_t sdsRecWrite64 (sdsRecId_t id, uint64_t timestamp, const void *buf, uint32_t buf_size) {
+  return sdsRecWriteRecord(id, timestamp, REC_SIZE_TS64, buf, buf_size);
+}
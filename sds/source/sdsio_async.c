@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2022-2023 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// SDS I/O asynchronous writes (I/O thread shared by the SDS I/O interface implementations)
+
+#include <string.h>
+
+#ifndef SDSIO_NO_LOCK
+#include "cmsis_compiler.h"
+#include "cmsis_os2.h"
+#endif
+#include "sdsio_async.h"
+
+#ifndef SDSIO_NO_LOCK
+
+// Asynchronous write queue of a stream
+typedef struct {
+  sdsioId_t      id;                    // Stream of queue (NULL: queue not used)
+  uint32_t       idx;                   // Index of oldest request
+  uint32_t       cnt;                   // Number of queued requests
+  uint32_t       sent;                  // Number of bytes of oldest request sent
+  sdsioRequest_t req[SDSIO_ASYNC_QUEUE_SIZE];
+} sdsioQueue_t;
+
+#define SDSIO_ASYNC_FLAG        1U      // I/O thread flag: request submitted
+
+static sdsioQueue_t       Queues[SDSIO_MAX_STREAMS];
+static uint32_t           QueueNext[SDSIO_MAX_STREAMS]; // Queue serviced next by I/O thread (round-robin)
+static osMutexId_t        sdsioQueueLockId;
+static osThreadId_t       sdsioThreadId[SDSIO_MAX_STREAMS];
+static uint32_t           Threads;      // Number of I/O threads
+static uint32_t           FrameSize;    // Maximum frame size (0: not limited)
+
+// Next queue of I/O thread with pending request in round-robin order (NULL: no request pending),
+// other is set when requests of other streams of the thread are pending as well
+static sdsioQueue_t *sdsioQueueNext (uint32_t thread, uint32_t *other) {
+  sdsioQueue_t *queue = NULL;
+  uint32_t      n, i;
+
+  *other = 0U;
+  osMutexAcquire(sdsioQueueLockId, osWaitForever);
+  for (n = 0U; n < SDSIO_MAX_STREAMS; n++) {
+    i = (QueueNext[thread] + n) % SDSIO_MAX_STREAMS;
+    if (((i % Threads) == thread) && (Queues[i].cnt != 0U)) {
+      if (queue != NULL) {
+        *other = 1U;
+        break;
+      }
+      queue             = &Queues[i];
+      QueueNext[thread] = (i + 1U) % SDSIO_MAX_STREAMS;
+    }
+  }
+  osMutexRelease(sdsioQueueLockId);
+
+  return queue;
+}
+
+// I/O thread: services asynchronous write requests of its streams round-robin
+// (queue n is serviced by I/O thread n % Threads).
+// Requests of a stream are executed in submission order. While requests of other streams are pending, the oldest
+// request of a stream is sent in chunks of up to SDSIO_MAX_CHUNK_SIZE bytes, so that a small request of one stream
+// is not blocked behind a large request of another. Otherwise the request is sent as one frame (limited to the
+// maximum frame size of the interface).
+static __NO_RETURN void sdsioThread (void *arg) {
+  sdsioQueue_t   *queue;
+  sdsioRequest_t *req;
+  uint32_t        thread = (uint32_t)(uintptr_t)arg;
+  uint32_t        other, limit, size, num;
+
+  while (1) {
+    queue = sdsioQueueNext(thread, &other);
+    if (queue == NULL) {
+      osThreadFlagsWait(SDSIO_ASYNC_FLAG, osFlagsWaitAny, osWaitForever);
+      continue;
+    }
+    req  = &queue->req[queue->idx];
+    size  = req->buf_size - queue->sent;
+    limit = FrameSize;
+    if ((other != 0U) && ((limit == 0U) || (limit > SDSIO_MAX_CHUNK_SIZE))) {
+      limit = SDSIO_MAX_CHUNK_SIZE;
+    }
+    if ((limit != 0U) && (size > limit)) {
+      size = limit;
+    }
+    num = sdsioWriteFrame(req->id, (const uint8_t *)req->buf + queue->sent, size);
+    queue->sent += num;
+    if ((num != size) || (queue->sent == req->buf_size)) {
+      // Request completed (or failed)
+      if (req->cb != NULL) {
+        req->cb(req->id, req->buf, queue->sent, req->arg);
+      }
+      osMutexAcquire(sdsioQueueLockId, osWaitForever);
+      queue->sent = 0U;
+      queue->idx  = (queue->idx + 1U) % SDSIO_ASYNC_QUEUE_SIZE;
+      queue->cnt--;
+      if (queue->cnt == 0U) {
+        queue->id = NULL;
+      }
+      osMutexRelease(sdsioQueueLockId);
+    }
+  }
+}
+
+// Create I/O threads and request queues
+int32_t sdsioAsyncCreate (uint32_t frame_size, uint32_t threads) {
+  uint32_t n;
+
+  if ((threads == 0U) || (threads > SDSIO_MAX_STREAMS)) {
+    return SDSIO_ERROR;
+  }
+  memset(Queues,    0, sizeof(Queues));
+  memset(QueueNext, 0, sizeof(QueueNext));
+  Threads   = threads;
+  FrameSize = frame_size;
+  sdsioQueueLockId = osMutexNew(NULL);
+  if (sdsioQueueLockId == NULL) {
+    return SDSIO_ERROR;
+  }
+  for (n = 0U; n < Threads; n++) {
+    QueueNext[n]     = n;
+    sdsioThreadId[n] = osThreadNew(sdsioThread, (void *)(uintptr_t)n, NULL);
+    if (sdsioThreadId[n] == NULL) {
+      Threads = n;
+      sdsioAsyncDelete();
+      return SDSIO_ERROR;
+    }
+  }
+  return SDSIO_OK;
+}
+
+// Delete I/O threads and request queues
+void sdsioAsyncDelete (void) {
+  uint32_t n;
+
+  for (n = 0U; n < Threads; n++) {
+    osThreadTerminate(sdsioThreadId[n]);
+  }
+  osMutexDelete(sdsioQueueLockId);
+}
+
+// Queue asynchronous write request for its stream
+int32_t sdsioAsyncSubmit (const sdsioRequest_t *req) {
+  sdsioQueue_t *queue = NULL;
+  uint32_t      n, thread = 0U;
+  int32_t       ret   = SDSIO_ERROR;
+
+  osMutexAcquire(sdsioQueueLockId, osWaitForever);
+  for (n = 0U; (n < SDSIO_MAX_STREAMS) && (queue == NULL); n++) {
+    if (Queues[n].id == req->id) {
+      queue = &Queues[n];
+    }
+  }
+  for (n = 0U; (n < SDSIO_MAX_STREAMS) && (queue == NULL); n++) {
+    if (Queues[n].id == NULL) {
+      queue     = &Queues[n];
+      queue->id = req->id;
+    }
+  }
+  if ((queue != NULL) && (queue->cnt < SDSIO_ASYNC_QUEUE_SIZE)) {
+    queue->req[(queue->idx + queue->cnt) % SDSIO_ASYNC_QUEUE_SIZE] = *req;
+    queue->cnt++;
+    thread = (uint32_t)(queue - Queues) % Threads;
+    ret    = SDSIO_OK;
+  }
+  osMutexRelease(sdsioQueueLockId);
+
+  if (ret == SDSIO_OK) {
+    osThreadFlagsSet(sdsioThreadId[thread], SDSIO_ASYNC_FLAG);
+  }
+  return ret;
+}
+
+// Wait until all queued asynchronous write requests of a stream are completed
+// (the queue of a stream is released when its last request is completed)
+void sdsioAsyncFlush (sdsioId_t id) {
+  uint32_t n, pending;
+
+  do {
+    pending = 0U;
+    osMutexAcquire(sdsioQueueLockId, osWaitForever);
+    for (n = 0U; n < SDSIO_MAX_STREAMS; n++) {
+      if (Queues[n].id == id) {
+        pending = 1U;
+      }
+    }
+    osMutexRelease(sdsioQueueLockId);
+    if (pending != 0U) {
+      // Wait instead of busy polling the queue
+      osDelay(1U);
+    }
+  } while (pending != 0U);
+}
+
+#else
+
+int32_t sdsioAsyncCreate (uint32_t frame_size, uint32_t threads) { (void)frame_size; (void)threads; return SDSIO_OK; }
+void    sdsioAsyncDelete (void) {}
+void    sdsioAsyncFlush  (sdsioId_t id) { (void)id; }
+
+// Without RTOS the request is executed immediately
+int32_t sdsioAsyncSubmit (const sdsioRequest_t *req) {
+  uint32_t num;
+
+  num = sdsioWrite(req->id, req->buf, req->buf_size);
+  if (req->cb != NULL) {
+    req->cb(req->id, req->buf, num, req->arg);
+  }
+  return SDSIO_OK;
+}
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022-2023 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// SDS I/O asynchronous writes (I/O thread shared by the SDS I/O interface implementations)
+
+#ifndef SDSIO_ASYNC_H
+#define SDSIO_ASYNC_H
+
+#include <stdint.h>
+
+#include "sdsio.h"
+
+// Configuration
+#ifndef SDSIO_ASYNC_QUEUE_SIZE
+#define SDSIO_ASYNC_QUEUE_SIZE  4U
+#endif
+
+#ifndef SDSIO_MAX_CHUNK_SIZE
+#define SDSIO_MAX_CHUNK_SIZE    2048U
+#endif
+
+#ifndef SDSIO_MAX_STREAMS
+#define SDSIO_MAX_STREAMS       8U
+#endif
+
+// Asynchronous write request
+typedef struct {
+  sdsioId_t        id;
+  const void      *buf;
+  uint32_t         buf_size;
+  sdsioWriteDone_t cb;
+  void            *arg;
+} sdsioRequest_t;
+
+/**
+  \fn          uint32_t sdsioWriteFrame (sdsioId_t id, const uint8_t *buf, uint32_t size)
+  \brief       Write data to stream in one write request (implemented by the SDS I/O interface).
+  \param[in]   id           \ref sdsioId_t
+  \param[in]   buf          pointer to buffer with data to write
+  \param[in]   size         number of bytes to write
+  \return      number of data bytes written
+*/
+uint32_t sdsioWriteFrame (sdsioId_t id, const uint8_t *buf, uint32_t size);
+
+/**
+  \fn          int32_t sdsioAsyncCreate (uint32_t frame_size, uint32_t threads)
+  \brief       Create I/O threads and request queues.
+  \param[in]   frame_size   maximum number of data bytes in one write request (0: not limited)
+  \param[in]   threads      number of I/O threads (1: shared by all streams,
+                                                  SDSIO_MAX_STREAMS: one for each stream)
+  \return      return code
+*/
+int32_t sdsioAsyncCreate (uint32_t frame_size, uint32_t threads);
+
+/**
+  \fn          void sdsioAsyncDelete (void)
+  \brief       Delete I/O threads and request queues.
+*/
+void sdsioAsyncDelete (void);
+
+/**
+  \fn          int32_t sdsioAsyncSubmit (const sdsioRequest_t *req)
+  \brief       Queue asynchronous write request for its stream.
+  \param[in]   req          pointer to \ref sdsioRequest_t
+  \return      return code (SDSIO_ERROR when the queue of the stream is full)
+*/
+int32_t sdsioAsyncSubmit (const sdsioRequest_t *req);
+
+/**
+  \fn          void sdsioAsyncFlush (sdsioId_t id)
+  \brief       Wait until all queued asynchronous write requests of a stream are completed
+               (must not be called from a completion callback).
+  \param[in]   id           \ref sdsioId_t
+*/
+void sdsioAsyncFlush (sdsioId_t id);
+
+#endif  /* SDSIO_ASYNC_H */
@@ -21,10 +21,12 @@
 #include <string.h>
 
 #ifndef SDSIO_NO_LOCK
+#include "cmsis_compiler.h"
 #include "cmsis_os2.h"
 #endif
 #include "iot_socket.h"
 #include "sdsio.h"
+#include "sdsio_async.h"
 
 // Configuration
 #ifndef SERVER_IP
@@ -38,6 +40,59 @@
 #define SOCKET_RECEIVE_TOUT     5000U
 #endif
 
+// Dedicated TCP connection for each stream (0: shared connection, 1: connection per stream)
+#ifndef SDSIO_SOCKET_PER_STREAM
+#define SDSIO_SOCKET_PER_STREAM 0
+#endif
+
+// Reconnect and resume streams after connection loss (0: disabled, 1: enabled)
+#ifndef SDSIO_SOCKET_RESUME
+#define SDSIO_SOCKET_RESUME     0
+#endif
+#ifndef SDSIO_RETX_BUF_SIZE
+#define SDSIO_RETX_BUF_SIZE     4096U
+#endif
+#ifndef SDSIO_RECONNECT_RETRIES
+#define SDSIO_RECONNECT_RETRIES 10U
+#endif
+#ifndef SDSIO_RECONNECT_DELAY
+#define SDSIO_RECONNECT_DELAY   1000U   /* in ticks */
+#endif
+
+// Acknowledged writes: maximum number of bytes not acknowledged by server (0: disabled)
+#ifndef SDSIO_ACK_WINDOW
+#define SDSIO_ACK_WINDOW        0U
+#endif
+#ifndef SDSIO_ACK_QUEUE_SIZE
+#define SDSIO_ACK_QUEUE_SIZE    4U
+#endif
+
+#if (SDSIO_SOCKET_RESUME != 0) && ((SDSIO_RETX_BUF_SIZE & (SDSIO_RETX_BUF_SIZE - 1U)) != 0U)
+#error "SDSIO retransmit buffer size must be a power of 2!"
+#endif
+#if (SDSIO_SOCKET_RESUME != 0) && (SDSIO_ACK_WINDOW > SDSIO_RETX_BUF_SIZE)
+#error "SDSIO acknowledge window must not exceed retransmit buffer size!"
+#endif
+#if (SDSIO_SOCKET_RESUME != 0) && (SDSIO_MAX_CHUNK_SIZE > SDSIO_RETX_BUF_SIZE)
+#error "SDSIO maximum chunk size must not exceed retransmit buffer size!"
+#endif
+
+// Maximum number of data bytes in one write request (a request interrupted by connection loss is retransmitted
+// from the retransmit buffer)
+#if (SDSIO_SOCKET_RESUME != 0)
+#define SDSIO_FRAME_SIZE        SDSIO_MAX_CHUNK_SIZE
+#else
+#define SDSIO_FRAME_SIZE        0U
+#endif
+
+// I/O threads: one for each stream with dedicated connections, so that a stalled connection
+// does not block the asynchronous writes of other streams
+#if (SDSIO_SOCKET_PER_STREAM != 0)
+#define SDSIO_ASYNC_THREADS     SDSIO_MAX_STREAMS
+#else
+#define SDSIO_ASYNC_THREADS     1U
+#endif
+
 // SDS I/O header
 typedef struct {
   uint32_t command;
@@ -51,14 +106,47 @@ typedef struct {
 #define SDSIO_CMD_CLOSE         2U
 #define SDSIO_CMD_WRITE         3U
 #define SDSIO_CMD_READ          4U
+#define SDSIO_CMD_SESSION       5U
+#define SDSIO_CMD_RESUME        6U
+#define SDSIO_CMD_ACK           7U
 
-static int32_t  socket        = -1;
+// Write request argument
+#define SDSIO_WRITE_ACK         1U      // Acknowledge requested
+
+// Stream control block
+typedef struct {
+  int32_t  socket;              // Connection used by stream (-1: free)
+  uint32_t sdsio_id;            // Identifier retrieved from server
+  uint32_t offset;              // Number of bytes sent (modulo 2^32)
+#if (SDSIO_SOCKET_RESUME != 0) || (SDSIO_ACK_WINDOW != 0U)
+  uint32_t error;               // Stream can not be continued without gap
+#endif
+#if (SDSIO_SOCKET_RESUME != 0)
+  uint8_t  retx_buf[SDSIO_RETX_BUF_SIZE]; // Last bytes sent (for retransmission)
+#endif
+#if (SDSIO_ACK_WINDOW != 0U)
+  uint32_t acked;               // Number of bytes persisted by server (modulo 2^32)
+  uint32_t lost;                // Number of bytes not persisted by server
+  uint32_t ack_idx;             // Index of oldest pending acknowledge
+  uint32_t ack_cnt;             // Number of pending acknowledges
+  uint32_t ack_offset[SDSIO_ACK_QUEUE_SIZE]; // Stream offsets of pending acknowledges
+#endif
+} sdsioStream_t;
+
+static int32_t        socket        = -1;
+static sdsioStream_t  Streams[SDSIO_MAX_STREAMS];
+#if (SDSIO_SOCKET_RESUME != 0)
+static uint32_t       session_id    = 0U;
+#endif
 
 // Lock function
 #ifndef SDSIO_NO_LOCK
 static osMutexId_t lock_id;
+static const osMutexAttr_t lock_attr = {
+  "sdsio", osMutexPrioInherit, NULL, 0U
+};
 static inline void sdsioLockCreate (void) {
-  lock_id = osMutexNew(NULL);
+  lock_id = osMutexNew(&lock_attr);
 }
 static inline void sdsioLockDelete (void) {
   osMutexDelete(lock_id);
@@ -69,26 +157,56 @@ static inline void sdsioLock (void) {
 static inline void sdsioUnLock (void) {
   osMutexRelease(lock_id);
 }
+static inline void sdsioWait (void) {
+  osDelay(1U);
+}
+static inline void sdsioDelay (uint32_t ticks) {
+  osDelay(ticks);
+}
+static inline uint32_t sdsioTicks (void) {
+  return osKernelGetTickCount();
+}
+static inline uint32_t sdsioReceiveTicks (void) {
+  return (uint32_t)(((uint64_t)SOCKET_RECEIVE_TOUT * osKernelGetTickFreq()) / 1000U);
+}
 #else
 static inline void sdsioLockCreate (void) {}
 static inline void sdsioLockDelete (void) {}
 static inline void sdsioLock       (void) {}
 static inline void sdsioUnLock     (void) {}
+static inline void sdsioWait       (void) {}
+static inline void sdsioDelay      (uint32_t ticks) { (void)ticks; }
+static inline uint32_t sdsioTicks        (void) { return 0U; }
+static inline uint32_t sdsioReceiveTicks (void) { return 0U; }
+#endif
+
+// Stream lock: frames on the shared connection are serialized,
+// dedicated connections are used by the stream only
+static inline void sdsioStreamLock (void) {
+#if (SDSIO_SOCKET_PER_STREAM == 0)
+  sdsioLock();
+#endif
+}
+static inline void sdsioStreamUnLock (void) {
+#if (SDSIO_SOCKET_PER_STREAM == 0)
+  sdsioUnLock();
 #endif
+}
 
 /**
-  \fn          uint32_t sdsioSend (const void *buf, uint32_t buf_size)
+  \fn          uint32_t sdsioSend (int32_t sock, const void *buf, uint32_t buf_size)
   \brief       Send data via iot socket
+  \param[in]   sock         socket
   \param[in]   buf          pointer to buffer with data to send
   \param[in]   buf_size     buffer size in bytes
   \return      number of bytes sent
 */
-static uint32_t sdsioSend (const void *buf, uint32_t buf_size) {
+static uint32_t sdsioSend (int32_t sock, const void *buf, uint32_t buf_size) {
   int32_t  status;
   uint32_t num = 0U;
 
   while (num < buf_size) {
-    status = iotSocketSend(socket, (const uint8_t *)buf + num, buf_size - num);
+    status = iotSocketSend(sock, (const uint8_t *)buf + num, buf_size - num);
     if (status >= 0) {
       num += (uint32_t)status;
     } else {
@@ -96,6 +214,8 @@ static uint32_t sdsioSend (const void *buf, uint32_t buf_size) {
       if (status != IOT_SOCKET_EAGAIN) {
         break;
       }
+      // Wait instead of busy polling the socket
+      sdsioWait();
     }
   }
 
@@ -103,48 +223,508 @@ static uint32_t sdsioSend (const void *buf, uint32_t buf_size) {
 }
 
 /**
-  \fn          uint32_t sdsioReceive (void *buf, uint32_t buf_size)
-  \brief       Receive data via iot socket
+  \fn          uint32_t sdsioReceive (int32_t sock, void *buf, uint32_t buf_size)
+  \brief       Receive data via iot socket (returns less data when nothing is received
+               for SOCKET_RECEIVE_TOUT)
+  \param[in]   sock         socket
   \param[out]  buf          pointer to buffer for data to read
   \param[in]   buf_size     buffer size in bytes
   \return      number of bytes received
 */
-static uint32_t sdsioReceive (void *buf, uint32_t buf_size) {
+static uint32_t sdsioReceive (int32_t sock, void *buf, uint32_t buf_size) {
   int32_t  status;
-  uint32_t num = 0U;
+  uint32_t num   = 0U;
+  uint32_t start = sdsioTicks();
 
   while (num < buf_size) {
-    status = iotSocketRecv(socket, (uint8_t *)buf + num, buf_size - num);
+    status = iotSocketRecv(sock, (uint8_t *)buf + num, buf_size - num);
     if (status >= 0) {
-      num += (uint32_t)status;
+      num  += (uint32_t)status;
+      start = sdsioTicks();
     } else {
       // Error
       if (status != IOT_SOCKET_EAGAIN) {
         break;
       }
+      // Timeout: no data received
+      if ((sdsioTicks() - start) >= sdsioReceiveTicks()) {
+        break;
+      }
+      // Wait instead of busy polling the socket
+      sdsioWait();
+    }
+  }
+
+  return num;
+}
+
+/**
+  \fn          int32_t sdsioConnect (void)
+  \brief       Create socket and connect to server
+  \return      socket or -1 on error
+*/
+static int32_t sdsioConnect (void) {
+  int32_t  sock;
+  uint32_t tout = SOCKET_RECEIVE_TOUT;
+
+  const uint8_t ip[] = SERVER_IP;
+
+  sock = iotSocketCreate(IOT_SOCKET_AF_INET, IOT_SOCKET_SOCK_STREAM, IOT_SOCKET_IPPROTO_TCP);
+  if (sock >= 0) {
+    iotSocketSetOpt(sock, IOT_SOCKET_SO_RCVTIMEO, &tout, sizeof(tout));
+    if (iotSocketConnect(sock, ip, 4, SERVER_PORT) != 0) {
+      iotSocketClose(sock);
+      sock = -1;
+    }
+  }
+
+  return sock;
+}
+
+/**
+  \fn          uint32_t sdsioSendFrame (const sdsioStream_t *stream, const void *buf, uint32_t buf_size, uint32_t argument)
+  \brief       Send write request (header and data) for stream
+  \param[in]   stream       pointer to stream control block
+  \param[in]   buf          pointer to buffer with data to send
+  \param[in]   buf_size     buffer size in bytes
+  \param[in]   argument     write request argument
+  \return      number of data bytes sent
+*/
+static uint32_t sdsioSendFrame (const sdsioStream_t *stream, const void *buf, uint32_t buf_size, uint32_t argument) {
+  header_t header;
+  uint32_t size;
+
+  header.command   = SDSIO_CMD_WRITE;
+  header.sdsio_id  = stream->sdsio_id;
+  header.argument  = argument;
+  header.data_size = buf_size;
+
+  // Send header
+  size = sizeof(header_t);
+  if (sdsioSend(stream->socket, &header, size) != size) {
+    return 0U;
+  }
+
+  // Send data
+  return sdsioSend(stream->socket, buf, buf_size);
+}
+
+#if (SDSIO_ACK_WINDOW != 0U)
+/**
+  Process acknowledge: oldest pending acknowledge of the stream is completed.
+  Receive:
+    header: command   = SDSIO_CMD_ACK
+            sdsio_id  = sdsio identifier
+            argument  = number of bytes persisted (modulo 2^32)
+            data_size = 0
+    data:   no data
+*/
+static void sdsioAckProcess (int32_t sock, const header_t *header) {
+  sdsioStream_t *stream;
+  uint32_t n;
+
+  for (n = 0U; n < SDSIO_MAX_STREAMS; n++) {
+    stream = &Streams[n];
+    if ((stream->socket == sock) && (stream->sdsio_id == header->sdsio_id) && (stream->ack_cnt != 0U)) {
+      // Data sent up to acknowledged request which is not persisted is lost
+      stream->acked   = header->argument;
+      stream->lost    = stream->ack_offset[stream->ack_idx] - header->argument;
+      stream->ack_idx = (stream->ack_idx + 1U) % SDSIO_ACK_QUEUE_SIZE;
+      stream->ack_cnt--;
+      break;
+    }
+  }
+}
+
+/**
+  Wait for the oldest pending acknowledge of the stream.
+  Error when no acknowledge is received in time (connection is considered lost).
+*/
+static int32_t sdsioAckWait (sdsioStream_t *stream) {
+  header_t header;
+  uint32_t cnt;
+
+  cnt = stream->ack_cnt;
+  while (stream->ack_cnt == cnt) {
+    if (sdsioReceive(stream->socket, &header, sizeof(header_t)) != sizeof(header_t)) {
+      return SDSIO_ERROR;
+    }
+    if (header.command == SDSIO_CMD_ACK) {
+      sdsioAckProcess(stream->socket, &header);
+    }
+  }
+
+  return SDSIO_OK;
+}
+#endif
+
+/**
+  \fn          uint32_t sdsioReceiveResponse (int32_t sock, header_t *header)
+  \brief       Receive response header (acknowledges received before are processed)
+  \param[in]   sock         socket
+  \param[out]  header       pointer to header
+  \return      number of bytes received
+*/
+static uint32_t sdsioReceiveResponse (int32_t sock, header_t *header) {
+  uint32_t size = sizeof(header_t);
+
+  while (sdsioReceive(sock, header, size) == size) {
+#if (SDSIO_ACK_WINDOW != 0U)
+    if (header->command == SDSIO_CMD_ACK) {
+      sdsioAckProcess(sock, header);
+      continue;
+    }
+#endif
+    return size;
+  }
+
+  return 0U;
+}
+
+/**
+  \fn          uint32_t sdsioSendChunk (sdsioStream_t *stream, const void *buf, uint32_t buf_size)
+  \brief       Send chunk of stream data, requesting acknowledges and waiting while window is full
+  \param[in]   stream       pointer to stream control block
+  \param[in]   buf          pointer to buffer with data to send
+  \param[in]   buf_size     buffer size in bytes
+  \return      number of data bytes sent
+*/
+static uint32_t sdsioSendChunk (sdsioStream_t *stream, const void *buf, uint32_t buf_size) {
+  uint32_t argument = 0U;
+  uint32_t num;
+#if (SDSIO_ACK_WINDOW != 0U)
+  uint32_t last;
+
+  // Backpressure: wait while window is full
+  while ((stream->ack_cnt != 0U) &&
+         (((stream->offset + buf_size - stream->acked) > SDSIO_ACK_WINDOW) ||
+          (stream->ack_cnt == SDSIO_ACK_QUEUE_SIZE))) {
+    if (sdsioAckWait(stream) != SDSIO_OK) {
+      return 0U;
+    }
+  }
+
+  // Request acknowledge for each quarter of the window
+  if (stream->ack_cnt == 0U) {
+    argument = SDSIO_WRITE_ACK;
+  } else {
+    last = stream->ack_offset[(stream->ack_idx + stream->ack_cnt - 1U) % SDSIO_ACK_QUEUE_SIZE];
+    if ((stream->offset + buf_size - last) >= (SDSIO_ACK_WINDOW / 4U)) {
+      argument = SDSIO_WRITE_ACK;
+    }
+  }
+#endif
+
+  num = sdsioSendFrame(stream, buf, buf_size, argument);
+
+#if (SDSIO_ACK_WINDOW != 0U)
+  if ((num == buf_size) && (argument == SDSIO_WRITE_ACK)) {
+    stream->ack_offset[(stream->ack_idx + stream->ack_cnt) % SDSIO_ACK_QUEUE_SIZE] = stream->offset + buf_size;
+    stream->ack_cnt++;
+  }
+#endif
+
+  return num;
+}
+
+#if (SDSIO_SOCKET_RESUME != 0)
+/**
+  Store sent data in stream retransmit buffer.
+*/
+static void sdsioRetxStore (sdsioStream_t *stream, const uint8_t *buf, uint32_t size) {
+  uint32_t offset, pos, n;
+
+  offset = stream->offset + size;
+  if (size > SDSIO_RETX_BUF_SIZE) {
+    buf += size - SDSIO_RETX_BUF_SIZE;
+    size = SDSIO_RETX_BUF_SIZE;
+  }
+  pos = (offset - size) & (SDSIO_RETX_BUF_SIZE - 1U);
+  n   = SDSIO_RETX_BUF_SIZE - pos;
+  if (n > size) {
+    n = size;
+  }
+  memcpy(&stream->retx_buf[pos], buf, n);
+  memcpy(&stream->retx_buf[0], buf + n, size - n);
+}
+
+/**
+  Establish new or continue existing session on connection.
+  Send:
+    header: command   = SDSIO_CMD_SESSION
+            sdsio_id  = not used
+            argument  = session identifier (0: new session)
+            data_size = 0
+    data:   no data
+  Receive:
+    header: command   = SDSIO_CMD_SESSION
+            sdsio_id  = not used
+            argument  = session identifier
+            data_size = 0
+    data:   no data
+*/
+static int32_t sdsioSession (int32_t sock) {
+  header_t header;
+  uint32_t size;
+
+  header.command   = SDSIO_CMD_SESSION;
+  header.sdsio_id  = 0U;
+  header.argument  = session_id;
+  header.data_size = 0U;
+
+  size = sizeof(header_t);
+  if ((sdsioSend(sock, &header, size)            == size) &&
+      (sdsioReceiveResponse(sock, &header) == size)) {
+    if ((header.command   == SDSIO_CMD_SESSION) &&
+        (header.data_size == 0U)                &&
+        ((session_id == 0U) || (header.argument == session_id))) {
+      session_id = header.argument;
+      return SDSIO_OK;
+    }
+  }
+
+  return SDSIO_ERROR;
+}
+
+/**
+  Resume stream on new connection: retrieve number of bytes persisted by the server
+  and retransmit missing data from the retransmit buffer.
+  Send:
+    header: command   = SDSIO_CMD_RESUME
+            sdsio_id  = sdsio identifier
+            argument  = not used
+            data_size = 0
+    data:   no data
+  Receive:
+    header: command   = SDSIO_CMD_RESUME
+            sdsio_id  = sdsio identifier (0: unknown stream)
+            argument  = number of bytes persisted (modulo 2^32)
+            data_size = 0
+    data:   no data
+*/
+static int32_t sdsioResume (sdsioStream_t *stream) {
+  header_t header;
+  uint32_t size, offset, pos, num;
+
+  header.command   = SDSIO_CMD_RESUME;
+  header.sdsio_id  = stream->sdsio_id;
+  header.argument  = 0U;
+  header.data_size = 0U;
+
+  size = sizeof(header_t);
+  if ((sdsioSend(stream->socket, &header, size)            != size) ||
+      (sdsioReceiveResponse(stream->socket, &header) != size)) {
+    return SDSIO_ERROR;
+  }
+  if ((header.command  != SDSIO_CMD_RESUME) ||
+      (header.sdsio_id != stream->sdsio_id)) {
+    // Stream is unknown to the server
+    stream->error = 1U;
+    return SDSIO_ERROR;
+  }
+
+  offset = header.argument;
+#if (SDSIO_ACK_WINDOW != 0U)
+  // Pending acknowledges are lost with the connection
+  stream->acked   = offset;
+  stream->ack_idx = 0U;
+  stream->ack_cnt = 0U;
+#endif
+  if ((stream->offset - offset) > SDSIO_RETX_BUF_SIZE) {
+    // Missing data is no longer available: do not append data after a gap
+    stream->error = 1U;
+    return SDSIO_ERROR;
+  }
+
+  // Retransmit missing data
+  while (offset != stream->offset) {
+    pos = offset & (SDSIO_RETX_BUF_SIZE - 1U);
+    num = stream->offset - offset;
+    if (num > (SDSIO_RETX_BUF_SIZE - pos)) {
+      num = SDSIO_RETX_BUF_SIZE - pos;
+    }
+    if (num > SDSIO_MAX_CHUNK_SIZE) {
+      num = SDSIO_MAX_CHUNK_SIZE;
+    }
+    if (sdsioSendFrame(stream, &stream->retx_buf[pos], num, 0U) != num) {
+      return SDSIO_ERROR;
+    }
+    offset += num;
+  }
+
+  return SDSIO_OK;
+}
+
+/**
+  Reconnect after connection loss, continue the session and resume
+  all streams which used the lost connection.
+*/
+static int32_t sdsioReconnect (int32_t sock_lost) {
+  int32_t  sock = -1;
+  int32_t  ret  = SDSIO_OK;
+  uint32_t n;
+
+  if (session_id == 0U) {
+    // Server does not support sessions
+    return SDSIO_ERROR;
+  }
+
+  iotSocketClose(sock_lost);
+  for (n = 0U; (n < SDSIO_RECONNECT_RETRIES) && (sock < 0); n++) {
+    sdsioDelay(SDSIO_RECONNECT_DELAY);
+    sock = sdsioConnect();
+    if ((sock >= 0) && (sdsioSession(sock) != SDSIO_OK)) {
+      iotSocketClose(sock);
+      sock = -1;
+    }
+  }
+  if (sock < 0) {
+    return SDSIO_ERROR;
+  }
+
+  if (sock_lost == socket) {
+    socket = sock;
+  }
+  for (n = 0U; n < SDSIO_MAX_STREAMS; n++) {
+    if ((Streams[n].socket == sock_lost) && (Streams[n].sdsio_id != 0U)) {
+      Streams[n].socket = sock;
+      if (sdsioResume(&Streams[n]) != SDSIO_OK) {
+        ret = SDSIO_ERROR;
+      }
     }
   }
 
+  return ret;
+}
+#endif
+
+/**
+  \fn          uint32_t sdsioWriteChunk (sdsioStream_t *stream, const uint8_t *buf, uint32_t size)
+  \brief       Write chunk of stream data (called with stream lock held)
+  \param[in]   stream       pointer to stream control block
+  \param[in]   buf          pointer to buffer with data to write
+  \param[in]   size         chunk size in bytes
+  \return      number of data bytes written
+*/
+static uint32_t sdsioWriteChunk (sdsioStream_t *stream, const uint8_t *buf, uint32_t size) {
+  uint32_t num;
+
+#if (SDSIO_SOCKET_RESUME != 0) || (SDSIO_ACK_WINDOW != 0U)
+  if (stream->error != 0U) {
+    return 0U;
+  }
+#endif
+
+  num = sdsioSendChunk(stream, buf, size);
+
+#if (SDSIO_SOCKET_RESUME != 0)
+  if ((num != size) && (sdsioReconnect(stream->socket) == SDSIO_OK)) {
+    num = sdsioSendChunk(stream, buf, size);
+  }
+  if (num == size) {
+    sdsioRetxStore(stream, buf, size);
+  } else {
+    // Data is lost: do not append further data after a gap
+    stream->error = 1U;
+#if (SDSIO_ACK_WINDOW != 0U)
+    stream->lost  = stream->offset - stream->acked;
+#endif
+  }
+#elif (SDSIO_ACK_WINDOW != 0U)
+  if (num != size) {
+    // Connection lost (or acknowledge not received in time): data not acknowledged is lost
+    stream->error = 1U;
+    stream->lost  = stream->offset - stream->acked;
+  }
+#endif
+
+  if (num == size) {
+    stream->offset += size;
+  }
+
   return num;
 }
 
+/**
+  \fn          uint32_t sdsioWriteFrame (sdsioId_t id, const uint8_t *buf, uint32_t size)
+  \brief       Write data to stream in one write request
+  \param[in]   id           \ref sdsioId_t
+  \param[in]   buf          pointer to buffer with data to write
+  \param[in]   size         number of bytes to write
+  \return      number of data bytes written
+*/
+uint32_t sdsioWriteFrame (sdsioId_t id, const uint8_t *buf, uint32_t size) {
+  uint32_t num;
+
+  sdsioStreamLock();
+  num = sdsioWriteChunk(id, buf, size);
+  sdsioStreamUnLock();
+
+  return num;
+}
+
+// Stream control block allocation (protected by lock)
+static sdsioStream_t * sdsioStreamAlloc (void) {
+  sdsioStream_t *stream = NULL;
+  uint32_t n;
+
+  sdsioLock();
+  for (n = 0U; n < SDSIO_MAX_STREAMS; n++) {
+    if (Streams[n].socket < 0) {
+      stream = &Streams[n];
+      stream->socket   = socket;
+      stream->sdsio_id = 0U;
+      stream->offset   = 0U;
+#if (SDSIO_SOCKET_RESUME != 0) || (SDSIO_ACK_WINDOW != 0U)
+      stream->error    = 0U;
+#endif
+#if (SDSIO_ACK_WINDOW != 0U)
+      stream->acked    = 0U;
+      stream->lost     = 0U;
+      stream->ack_idx  = 0U;
+      stream->ack_cnt  = 0U;
+#endif
+      break;
+    }
+  }
+  sdsioUnLock();
+
+  return stream;
+}
+
+static void sdsioStreamFree (sdsioStream_t *stream) {
+#if (SDSIO_SOCKET_PER_STREAM != 0)
+  if (stream->socket >= 0) {
+    iotSocketClose(stream->socket);
+  }
+#endif
+  stream->sdsio_id = 0U;
+  stream->socket   = -1;
+}
+
 
 // SDS I/O functions
 
 /** Initialize I/O interface */
 int32_t sdsioInit (void) {
   int32_t  ret  = SDSIO_ERROR;
-  uint32_t tout = SOCKET_RECEIVE_TOUT;
+  uint32_t n;
 
-  const uint8_t ip[] = SERVER_IP;
+  for (n = 0U; n < SDSIO_MAX_STREAMS; n++) {
+    Streams[n].socket   = -1;
+    Streams[n].sdsio_id = 0U;
+  }
 
   sdsioLockCreate();
-  socket = iotSocketCreate(IOT_SOCKET_AF_INET, IOT_SOCKET_SOCK_STREAM, IOT_SOCKET_IPPROTO_TCP);
+  socket = sdsioConnect();
   if (socket >= 0) {
-    iotSocketSetOpt(socket, IOT_SOCKET_SO_RCVTIMEO, &tout, sizeof(tout));
-    if (iotSocketConnect(socket, ip, 4, SERVER_PORT) == 0) {
-      ret = SDSIO_OK;
-    } else {
+#if (SDSIO_SOCKET_RESUME != 0)
+    // Without session support on the server streams are not resumed
+    session_id = 0U;
+    sdsioSession(socket);
+#endif
+    ret = sdsioAsyncCreate(SDSIO_FRAME_SIZE, SDSIO_ASYNC_THREADS);
+    if (ret == SDSIO_ERROR) {
       iotSocketClose(socket);
       socket = -1;
     }
@@ -158,6 +738,14 @@ int32_t sdsioInit (void) {
 
 /** Un-initialize I/O interface */
 int32_t sdsioUninit (void) {
+  uint32_t n;
+
+  sdsioAsyncDelete();
+  for (n = 0U; n < SDSIO_MAX_STREAMS; n++) {
+    if (Streams[n].socket >= 0) {
+      sdsioStreamFree(&Streams[n]);
+    }
+  }
   iotSocketClose(socket);
   socket = -1;
   sdsioLockDelete();
@@ -166,6 +754,7 @@ int32_t sdsioUninit (void) {
 
 /**
   Open I/O stream
+  With SDSIO_SOCKET_PER_STREAM a dedicated connection is created for the stream.
   Send:
     header: command   = SDSIO_CMD_OPEN
             sdsio_id  = not used
@@ -180,12 +769,23 @@ int32_t sdsioUninit (void) {
     data:   no data
 */
 sdsioId_t sdsioOpen (const char *name, sdsioMode_t mode) {
+  sdsioStream_t *stream = NULL;
   header_t header;
   uint32_t size;
-  uint32_t sdsio_id = 0U;
 
   if (name != NULL) {
-    sdsioLock();
+    stream = sdsioStreamAlloc();
+  }
+  if (stream != NULL) {
+#if (SDSIO_SOCKET_PER_STREAM != 0)
+    stream->socket = sdsioConnect();
+#if (SDSIO_SOCKET_RESUME != 0)
+    if ((stream->socket >= 0) && (session_id != 0U)) {
+      sdsioSession(stream->socket);
+    }
+#endif
+#endif
+    sdsioStreamLock();
 
     header.command   = SDSIO_CMD_OPEN;
     header.sdsio_id  = 0U;
@@ -194,32 +794,38 @@ sdsioId_t sdsioOpen (const char *name, sdsioMode_t mode) {
 
     // Send header
     size = sizeof(header_t);
-    if (sdsioSend(&header, size) == size) {
+    if (sdsioSend(stream->socket, &header, size) == size) {
 
       // Send stream name
       size = header.data_size;
-      if (sdsioSend(name, size) == size) {
+      if (sdsioSend(stream->socket, name, size) == size) {
 
         // Receive header
         size = sizeof(header_t);
-        if (sdsioReceive(&header, size) == size) {
+        if (sdsioReceiveResponse(stream->socket, &header) == size) {
           if ((header.command   == SDSIO_CMD_OPEN) &&
               (header.argument  == mode)           &&
               (header.data_size == 0U)) {
-            sdsio_id = header.sdsio_id;
+            stream->sdsio_id = header.sdsio_id;
           }
         }
       }
     }
 
-    sdsioUnLock();
+    sdsioStreamUnLock();
+
+    if (stream->sdsio_id == 0U) {
+      sdsioStreamFree(stream);
+      stream = NULL;
+    }
   }
 
-  return (sdsioId_t)sdsio_id;
+  return (sdsioId_t)stream;
 }
 
 /**
   Close I/O stream.
+  Queued asynchronous writes of the stream are completed before the stream is closed.
   Send:
     header: command   = SDSIO_CMD_CLOSE
             sdsio_id  = sdsio identifier
@@ -228,25 +834,36 @@ sdsioId_t sdsioOpen (const char *name, sdsioMode_t mode) {
     data:   no data
 */
 int32_t sdsioClose (sdsioId_t id) {
+  sdsioStream_t *stream = id;
   header_t header;
   uint32_t size;
   int32_t  ret = SDSIO_ERROR;
 
-  if (id != NULL) {
-    sdsioLock();
+  if (stream != NULL) {
+    // Requests queued by sdsioWriteAsync are written before close
+    sdsioAsyncFlush(id);
+
+    sdsioStreamLock();
+
+#if (SDSIO_ACK_WINDOW != 0U)
+    // Receive pending acknowledges (not on a lost connection)
+    while ((stream->error == 0U) && (stream->ack_cnt != 0U) && (sdsioAckWait(stream) == SDSIO_OK));
+#endif
 
     header.command   = SDSIO_CMD_CLOSE;
-    header.sdsio_id  = (uint32_t)id;
+    header.sdsio_id  = stream->sdsio_id;
     header.argument  = 0U;
     header.data_size = 0U;
 
     // Send Header
     size = sizeof(header_t);
-    if (sdsioSend(&header, size) == size) {
+    if (sdsioSend(stream->socket, &header, size) == size) {
       ret = SDSIO_OK;
     }
 
-    sdsioUnLock();
+    sdsioStreamUnLock();
+
+    sdsioStreamFree(stream);
   }
 
   return ret;
@@ -254,42 +871,73 @@ int32_t sdsioClose (sdsioId_t id) {
 
 /**
   Write data to I/O stream.
-  Send:
+  Data is split into chunks of up to SDSIO_MAX_CHUNK_SIZE bytes. The lock is held
+  only for one chunk, so that chunks of other streams can be interleaved.
+  The server appends chunks to the stream identified by sdsio_id.
+  With SDSIO_SOCKET_RESUME a lost connection is re-established and the chunk is sent again
+  after the data not persisted by the server is retransmitted.
+  With SDSIO_ACK_WINDOW acknowledges are requested and writing waits while the number
+  of bytes not acknowledged would exceed the window.
+  Send (for each chunk):
     header: command   = SDSIO_CMD_WRITE
             sdsio_id  = sdsio identifier
-            argument  = not used
-            data_size = number of data bytes
+            argument  = SDSIO_WRITE_ACK when acknowledge is requested, otherwise 0
+            data_size = number of data bytes in chunk
     data:   data to be written
+  Receive (when acknowledge is requested, asynchronously):
+    header: command   = SDSIO_CMD_ACK
+            sdsio_id  = sdsio identifier
+            argument  = number of bytes persisted (modulo 2^32)
+            data_size = 0
+    data:   no data
 */
 uint32_t sdsioWrite (sdsioId_t id, const void *buf, uint32_t buf_size) {
-  header_t header;
-  uint32_t size;
+  sdsioStream_t *stream = id;
+  const uint8_t *data   = buf;
+  uint32_t size, chunk;
   uint32_t num = 0U;
 
-  if ((id != NULL) && (buf != NULL) && (buf_size != 0U)) {
-    sdsioLock();
-
-    header.command   = SDSIO_CMD_WRITE;
-    header.sdsio_id  = (uint32_t)id;
-    header.argument  = 0U;
-    header.data_size = buf_size;
+  if ((stream != NULL) && (buf != NULL) && (buf_size != 0U)) {
+    while (num < buf_size) {
+      chunk = buf_size - num;
+      if (chunk > SDSIO_MAX_CHUNK_SIZE) {
+        chunk = SDSIO_MAX_CHUNK_SIZE;
+      }
 
-    // Send header
-    size = sizeof(header_t);
-    if (sdsioSend(&header, size) == size) {
+      size = sdsioWriteFrame(stream, data + num, chunk);
 
-      // Send Data
-      if (sdsioSend(buf, buf_size) == buf_size) {
-        num = buf_size;
+      if (size != chunk) {
+        break;
       }
+      num += chunk;
     }
-
-    sdsioUnLock();
   }
 
   return num;
 }
 
+/**
+  Submit asynchronous write to I/O stream.
+  Request is queued for the stream and executed by the I/O thread (requests of a stream in submission order,
+  streams round-robin).
+  Completion callback is called from the I/O thread with number of bytes written.
+*/
+int32_t sdsioWriteAsync (sdsioId_t id, const void *buf, uint32_t buf_size, sdsioWriteDone_t cb, void *arg) {
+  sdsioRequest_t req;
+  int32_t        ret = SDSIO_ERROR;
+
+  if ((id != NULL) && (buf != NULL) && (buf_size != 0U)) {
+    req.id       = id;
+    req.buf      = buf;
+    req.buf_size = buf_size;
+    req.cb       = cb;
+    req.arg      = arg;
+    ret = sdsioAsyncSubmit(&req);
+  }
+
+  return ret;
+}
+
 /**
   Read data from I/O stream.
   Send:
@@ -306,39 +954,64 @@ uint32_t sdsioWrite (sdsioId_t id, const void *buf, uint32_t buf_size) {
     data    data read
 */
 uint32_t sdsioRead (sdsioId_t id, void *buf, uint32_t buf_size) {
+  sdsioStream_t *stream = id;
   header_t header;
   uint32_t size;
   uint32_t num = 0U;
 
-  if ((id != NULL) && (buf != NULL) && (buf_size != 0U)) {
-    sdsioLock();
+  if ((stream != NULL) && (buf != NULL) && (buf_size != 0U)) {
+    sdsioStreamLock();
 
     header.command   = SDSIO_CMD_READ;
-    header.sdsio_id  = (uint32_t)id;
+    header.sdsio_id  = stream->sdsio_id;
     header.argument  = buf_size;
     header.data_size = 0U;
 
     // Send header
     size = sizeof(header_t);
-    if (sdsioSend(&header, size) == size) {
+    if (sdsioSend(stream->socket, &header, size) == size) {
 
       // Receive header
-      if (sdsioReceive(&header, size) == size) {
-        if ((header.command   == SDSIO_CMD_READ) &&
-            (header.sdsio_id  == (uint32_t)id)   &&
+      if (sdsioReceiveResponse(stream->socket, &header) == size) {
+        if ((header.command   == SDSIO_CMD_READ)     &&
+            (header.sdsio_id  == stream->sdsio_id)   &&
             (header.data_size <= buf_size)) {
 
           // Receive data
           size = header.data_size;
-          if (sdsioReceive(buf, size) == size) {
+          if (sdsioReceive(stream->socket, buf, size) == size) {
             num = size;
           }
         }
       }
     }
 
-    sdsioUnLock();
+    sdsioStreamUnLock();
   }
 
   return num;
 }
+
+/**
+  Get I/O stream information.
+*/
+int32_t sdsioGetInfo (sdsioId_t id, sdsioInfo_t *info) {
+  sdsioStream_t *stream = id;
+  int32_t ret = SDSIO_ERROR;
+
+  if ((stream != NULL) && (info != NULL)) {
+    sdsioStreamLock();
+    info->bytes_sent  = stream->offset;
+#if (SDSIO_ACK_WINDOW != 0U)
+    info->bytes_acked = stream->acked;
+    info->bytes_lost  = stream->lost;
+#else
+    info->bytes_acked = 0U;
+    info->bytes_lost  = 0U;
+#endif
+    sdsioStreamUnLock();
+    ret = SDSIO_OK;
+  }
+
+  return ret;
+}
@@ -21,11 +21,13 @@
 #include <string.h>
 
 #ifndef SDSIO_NO_LOCK
+#include "cmsis_compiler.h"
 #include "cmsis_os2.h"
 #endif
 
 #include "rl_usb.h"                     // Keil.MDK-Plus::USB:CORE
 #include "sdsio.h"
+#include "sdsio_async.h"
 
 #ifndef SDSIO_USB_DEVICE_INDEX
 #define SDSIO_USB_DEVICE_INDEX  0U
@@ -48,8 +50,11 @@ typedef struct {
 // Lock function
 #ifndef SDSIO_NO_LOCK
 static osMutexId_t lock_id;
+static const osMutexAttr_t lock_attr = {
+  "sdsio", osMutexPrioInherit, NULL, 0U
+};
 static inline void sdsioLockCreate (void) {
-  lock_id = osMutexNew(NULL);
+  lock_id = osMutexNew(&lock_attr);
 }
 static inline void sdsioLockDelete (void) {
   osMutexDelete(lock_id);
@@ -60,11 +65,15 @@ static inline void sdsioLock (void) {
 static inline void sdsioUnLock (void) {
   osMutexRelease(lock_id);
 }
+static inline void sdsioWait (void) {
+  osDelay(1U);
+}
 #else
 static inline void sdsioLockCreate (void) {}
 static inline void sdsioLockDelete (void) {}
 static inline void sdsioLock       (void) {}
 static inline void sdsioUnLock     (void) {}
+static inline void sdsioWait       (void) {}
 #endif
 
 static CDC_LINE_CODING cdc_acm_line_coding = { 0U, 0U, 0U, 0U };
@@ -101,6 +110,8 @@ static uint32_t sdsioSend (const void *buf, uint32_t buf_size) {
       if ((status != usbDriverBusy) && (status != usbTimeout)) {
         break;
       }
+      // Wait instead of busy polling the interface
+      sdsioWait();
     }
   }
 
@@ -129,6 +140,8 @@ static uint32_t sdsioReceive (void *buf, uint32_t buf_size) {
       if ((status != usbDriverBusy) && (status != usbTimeout)) {
         break;
       }
+      // Wait instead of busy polling the interface
+      sdsioWait();
     }
   }
 
@@ -149,6 +162,9 @@ int32_t sdsioInit (void) {
       ret = SDSIO_OK;
     }
   }
+  if (ret == SDSIO_OK) {
+    ret = sdsioAsyncCreate(0U, 1U);
+  }
   if (ret == SDSIO_ERROR) {
     sdsioLockDelete();
   }
@@ -158,6 +174,7 @@ int32_t sdsioInit (void) {
 
 /** Un-initialize I/O interface */
 int32_t sdsioUninit (void) {
+  sdsioAsyncDelete();
   USBD_Disconnect(SDSIO_USB_DEVICE_INDEX);
   USBD_Uninitialize(SDSIO_USB_DEVICE_INDEX);
   sdsioLockDelete();
@@ -220,6 +237,7 @@ sdsioId_t sdsioOpen (const char *name, sdsioMode_t mode) {
 
 /**
   Close I/O stream.
+  Queued asynchronous writes of the stream are completed before the stream is closed.
   Send:
     header: command   = SDSIO_CMD_CLOSE
             sdsio_id  = sdsio identifier
@@ -233,6 +251,9 @@ int32_t sdsioClose (sdsioId_t id) {
   int32_t  ret = SDSIO_ERROR;
 
   if (id != NULL) {
+    // Requests queued by sdsioWriteAsync are written before close
+    sdsioAsyncFlush(id);
+
     sdsioLock();
 
     header.command   = SDSIO_CMD_CLOSE;
@@ -252,44 +273,97 @@ int32_t sdsioClose (sdsioId_t id) {
   return ret;
 }
 
+/**
+  \fn          uint32_t sdsioWriteFrame (sdsioId_t id, const uint8_t *buf, uint32_t size)
+  \brief       Write data to stream in one write request
+  \param[in]   id           \ref sdsioId_t
+  \param[in]   buf          pointer to buffer with data to write
+  \param[in]   size         number of bytes to write
+  \return      number of data bytes written
+*/
+uint32_t sdsioWriteFrame (sdsioId_t id, const uint8_t *buf, uint32_t size) {
+  header_t header;
+  uint32_t num;
+
+  header.command   = SDSIO_CMD_WRITE;
+  header.sdsio_id  = (uint32_t)id;
+  header.argument  = 0U;
+  header.data_size = size;
+
+  sdsioLock();
+
+  // Send header
+  num = sizeof(header_t);
+  if (sdsioSend(&header, num) == num) {
+
+    // Send Data
+    num = sdsioSend(buf, size);
+  } else {
+    num = 0U;
+  }
+
+  sdsioUnLock();
+
+  return num;
+}
+
 /**
   Write data to I/O stream.
-  Send:
+  Data is split into chunks of up to SDSIO_MAX_CHUNK_SIZE bytes. The lock is held
+  only for one chunk, so that chunks of other streams can be interleaved.
+  The server appends chunks to the stream identified by sdsio_id.
+  Send (for each chunk):
     header: command   = SDSIO_CMD_WRITE
             sdsio_id  = sdsio identifier
             argument  = not used
-            data_size = number of data bytes
+            data_size = number of data bytes in chunk
     data:   data to be written
 */
 uint32_t sdsioWrite (sdsioId_t id, const void *buf, uint32_t buf_size) {
-  header_t header;
-  uint32_t size;
+  uint32_t size, chunk;
   uint32_t num = 0U;
 
   if ((id != NULL) && (buf != NULL) && (buf_size != 0U)) {
-    sdsioLock();
-
-    header.command   = SDSIO_CMD_WRITE;
-    header.sdsio_id  = (uint32_t)id;
-    header.argument  = 0U;
-    header.data_size = buf_size;
+    while (num < buf_size) {
+      chunk = buf_size - num;
+      if (chunk > SDSIO_MAX_CHUNK_SIZE) {
+        chunk = SDSIO_MAX_CHUNK_SIZE;
+      }
 
-    // Send header
-    size = sizeof(header_t);
-    if (sdsioSend(&header, size) == size) {
+      size = sdsioWriteFrame(id, (const uint8_t *)buf + num, chunk);
 
-      // Send Data
-      if (sdsioSend(buf, buf_size) == buf_size) {
-        num = buf_size;
+      if (size != chunk) {
+        break;
       }
+      num += chunk;
     }
-
-    sdsioUnLock();
   }
 
   return num;
 }
 
+/**
+  Submit asynchronous write to I/O stream.
+  Request is queued for the stream and executed by the I/O thread (requests of a stream in submission order,
+  streams round-robin).
+  Completion callback is called from the I/O thread with number of bytes written.
+*/
+int32_t sdsioWriteAsync (sdsioId_t id, const void *buf, uint32_t buf_size, sdsioWriteDone_t cb, void *arg) {
+  sdsioRequest_t req;
+  int32_t        ret = SDSIO_ERROR;
+
+  if ((id != NULL) && (buf != NULL) && (buf_size != 0U)) {
+    req.id       = id;
+    req.buf      = buf;
+    req.buf_size = buf_size;
+    req.cb       = cb;
+    req.arg      = arg;
+    ret = sdsioAsyncSubmit(&req);
+  }
+
+  return ret;
+}
+
 /**
   Read data from I/O stream.
   Send:
@@ -342,3 +416,14 @@ uint32_t sdsioRead (sdsioId_t id, void *buf, uint32_t buf_size) {
 
   return num;
 }
+
+/**
+  Get I/O stream information.
+  Not supported: data is not acknowledged by the server.
+*/
+int32_t sdsioGetInfo (sdsioId_t id, sdsioInfo_t *info) {
+  (void)id;
+  (void)info;
+
+  return SDSIO_ERROR;
+}
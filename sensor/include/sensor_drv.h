@@ -137,6 +137,15 @@ uint32_t sensorReadSamples (sensorId_t id, uint32_t num_samples, void *buf, uint
 */
 void *sensorGetBlockData (sensorId_t id);
 
+/**
+  \fn          int32_t sensorGetTimestamp (sensorId_t id, uint64_t *timestamp)
+  \brief       Get hardware timestamp of first sample returned by last \ref sensorReadSamples.
+  \param[in]   id          \ref sensorId_t
+  \param[out]  timestamp   pointer to timestamp in microseconds
+  \return      return code (SENSOR_ERROR when sensor does not provide hardware timestamps)
+*/
+int32_t sensorGetTimestamp (sensorId_t id, uint64_t *timestamp);
+
 #ifdef  __cplusplus
 }
 #endif
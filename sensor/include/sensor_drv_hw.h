@@ -65,6 +65,12 @@ extern "C"
   \brief       Get block data.
   \return      pointer to block data
 */
+/**
+  \fn          int32_t sensorDrvHW_GetTimestamp (uint64_t *timestamp)
+  \brief       Get hardware timestamp of first sample returned by last read (optional).
+  \param[out]  timestamp   pointer to timestamp in microseconds
+  \return      return code
+*/
 
 /// Functions
 typedef const struct {
@@ -74,6 +80,7 @@ typedef const struct {
   uint32_t (*GetOverflow)    (void);
   uint32_t (*ReadSamples)    (uint32_t num_samples, void *buf);
   void *   (*GetBlockData)   (void);
+  int32_t  (*GetTimestamp)   (uint64_t *timestamp);
 } sensorDrvHW_t;
 
 extern sensorDrvHW_t sensorDrvHW_0;
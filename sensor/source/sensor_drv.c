@@ -339,3 +339,15 @@ void *sensorGetBlockData (sensorId_t id) {
 
   return block_data;
 }
+
+// Get hardware timestamp
+int32_t sensorGetTimestamp (sensorId_t id, uint64_t *timestamp) {
+  sensor_t *sensor = id;
+  int32_t ret = SENSOR_ERROR;
+
+  if ((sensor != NULL) && (timestamp != NULL) && (sensor->drw_hw->GetTimestamp != NULL)) {
+    ret = sensor->drw_hw->GetTimestamp(timestamp);
+  }
+
+  return ret;
+}
@@ -18,16 +18,25 @@
 
 
 import logging
+import sys
 from os import path
-from struct import unpack
+
+sys.path.append(path.join(path.dirname(path.abspath(__file__)), "..", "..", "..", "utilities", "SDS-Lib"))
+import sds_record
+try:
+    import sds_data
+except ImportError:
+    # numpy is not installed: records are read one by one with the standard library reader
+    sds_data = None
 
 
 class RecordManager:
     def __init__(self):
         self.WINDOW_SIZE        = 10000 #ms
         self.SLIDE_INTERVAL     = 1000  #ms
-        self.HEADER_SIZE        = 8     #B
-        self.TIMESTAMP_SIZE     = 4     #B
+        self.tick_frequency     = 1000  #Hz
+        self.records            = None
+        self.record             = 0
         self.data_buff          = bytearray()
         self.timestamp          = []
         self.data_size          = []
@@ -43,6 +52,14 @@ class RecordManager:
     # Flush variables
     def flush(self):
         logging.info("Flush Record Data")
+        if self.records is not None:
+            summary = self.records.summary if sds_data is not None else self.records.summary()
+            if summary != "":
+                logging.info(f"Record Data damaged: {summary}")
+            if sds_data is not None:
+                self.records.close()
+        self.records            = None
+        self.record             = 0
         self.data_buff          = bytearray()
         self.timestamp          = []
         self.data_size          = []
@@ -58,11 +75,30 @@ class RecordManager:
     # Read one Record from data file and save acquired data in corresponding buffers
     def __getRecord(self):
         logging.info("Get Record Data")
-        data = readFile(self.HEADER_SIZE)
-        if len(data) == self.HEADER_SIZE:
-            self.timestamp.append(unpack("I", data[:self.TIMESTAMP_SIZE])[0])
-            self.data_size.append(unpack("I", data[self.TIMESTAMP_SIZE:])[0])
-            self.data_buff.extend(readFile(self.data_size[-1]))
+        try:
+            if self.records is None:
+                if sds_data is not None:
+                    self.records = sds_data.RecordFile(file)
+                else:
+                    self.records = sds_record.RecordReader(file)
+            if sds_data is None:
+                record = self.records.read()
+            elif self.record < len(self.records):
+                record = self.records.record(self.record)
+                self.record += 1
+            else:
+                record = None
+        except Exception as e:
+            logging.debug(f"An error occurred when reading record: {e}")
+            record = None
+        if record is not None:
+            timestamp, data = record
+            # Convert timestamp from tick-frequency to [ms]
+            if self.tick_frequency != 1000:
+                timestamp = timestamp * 1000 / self.tick_frequency
+            self.timestamp.append(timestamp)
+            self.data_size.append(len(data))
+            self.data_buff.extend(memoryview(data))
             logging.debug(f"Record Data size: {len(self.data_buff)}")
         else:
             logging.info("No Record")
@@ -261,20 +297,24 @@ def openFile(name):
         logging.info(f"An error occurred when trying to open recording: {e}")
 
 
-## Read data bytes from sensor recording file
-#  @param n_bytes number of bytes to read
-#  @return data
-def readFile(n_bytes):
-    global file
-
+## Read timestamp tick frequency from sensor metadata file (default: 1000 for 1 ms)
+#  @param name name of metadata file
+#  @return tick_frequency tick frequency in Hz
+def readTickFrequency(name):
+    tick_frequency = 1000
     try:
-        logging.info("Read recording file")
-        data = bytearray(file.read(n_bytes))
+        with open(f"{name}", "r") as yml_file:
+            for line in yml_file:
+                key, _, value = line.partition(":")
+                if key.strip() == "tick-frequency":
+                    tick_frequency = int(value.split("#")[0].strip())
+                    break
+    except FileNotFoundError:
+        pass
     except Exception as e:
-        logging.debug(f"An error occurred when reading n_bytes = {n_bytes}: {e}")
-        data = bytearray()
-
-    return data
+        logging.info(f"An error occurred when reading metadata file: {e}")
+    logging.info(f"Timestamp tick frequency: {tick_frequency} Hz")
+    return tick_frequency
 
 
 ## Close sensor recording file
@@ -356,6 +396,7 @@ def wrCONTROL(value):
             logging.info("Enable Sensor")
             if SENSOR_NAME_VALID:
                 openFile(f"{sensor_filename}.{sensor_idx}.sds")
+                Record.tick_frequency = readTickFrequency(f"{sensor_filename}.sds.yml")
             if (value & CONTROL_DMA_Msk) == 0:
                 FIFO = FifoBuff(((FIFO_SIZE // SAMPLE_SIZE) * SAMPLE_SIZE), (DATA_THRESHOLD * SAMPLE_SIZE))
             sensor_idx += 1
@@ -273,10 +273,11 @@ sensorDrvHW_t sensorDrvHW_0 = {
   NULL,
 #endif
 #if (SENSOR0_DMA_MODE != 0U)
-  GetBlockData_0
+  GetBlockData_0,
 #else
-  NULL
+  NULL,
 #endif
+  NULL
 };
 
 #endif
@@ -492,10 +493,11 @@ sensorDrvHW_t sensorDrvHW_1 = {
   NULL,
 #endif
 #if (SENSOR1_DMA_MODE != 0U)
-  GetBlockData_1
+  GetBlockData_1,
 #else
-  NULL
+  NULL,
 #endif
+  NULL
 };
 
 #endif
@@ -711,10 +713,11 @@ sensorDrvHW_t sensorDrvHW_2 = {
   NULL,
 #endif
 #if (SENSOR2_DMA_MODE != 0U)
-  GetBlockData_2
+  GetBlockData_2,
 #else
-  NULL
+  NULL,
 #endif
+  NULL
 };
 
 #endif
@@ -930,10 +933,11 @@ sensorDrvHW_t sensorDrvHW_3 = {
   NULL,
 #endif
 #if (SENSOR3_DMA_MODE != 0U)
-  GetBlockData_3
+  GetBlockData_3,
 #else
-  NULL
+  NULL,
 #endif
+  NULL
 };
 
 #endif
@@ -1149,10 +1153,11 @@ sensorDrvHW_t sensorDrvHW_4 = {
   NULL,
 #endif
 #if (SENSOR4_DMA_MODE != 0U)
-  GetBlockData_4
+  GetBlockData_4,
 #else
-  NULL
+  NULL,
 #endif
+  NULL
 };
 
 #endif
@@ -1368,10 +1373,11 @@ sensorDrvHW_t sensorDrvHW_5 = {
   NULL,
 #endif
 #if (SENSOR5_DMA_MODE != 0U)
-  GetBlockData_5
+  GetBlockData_5,
 #else
-  NULL
+  NULL,
 #endif
+  NULL
 };
 
 #endif
@@ -1587,10 +1593,11 @@ sensorDrvHW_t sensorDrvHW_6 = {
   NULL,
 #endif
 #if (SENSOR6_DMA_MODE != 0U)
-  GetBlockData_6
+  GetBlockData_6,
 #else
-  NULL
+  NULL,
 #endif
+  NULL
 };
 
 #endif
@@ -1806,10 +1813,11 @@ sensorDrvHW_t sensorDrvHW_7 = {
   NULL,
 #endif
 #if (SENSOR7_DMA_MODE != 0U)
-  GetBlockData_7
+  GetBlockData_7,
 #else
-  NULL
+  NULL,
 #endif
+  NULL
 };
 
 #endif
@@ -0,0 +1,292 @@
+# Copyright (c) 2023 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Python SDS Recording Analyzer (record timing and integrity report in JSON format)
+
+import argparse
+import glob
+import json
+import sys
+from os import path
+
+import numpy as np
+import yaml
+
+sys.path.append(path.join(path.dirname(path.abspath(__file__)), "..", "SDS-Lib"))
+import sds_container
+import sds_data
+import sds_timing
+
+# Maximum number of record indexes listed for each finding (all are counted)
+LIST_SIZE = 20
+
+# Timestamp range of 32-bit record timestamps (timestamps wrap around)
+TIMESTAMP_RANGE = 1 << 32
+
+
+# Return sorted list of SDS data files and container files of file names, directories and glob patterns
+def findFiles(patterns):
+    files = []
+    for pattern in patterns:
+        if path.isdir(pattern):
+            files += glob.glob(path.join(pattern, "*.sds")) + glob.glob(path.join(pattern, "*.sdsc"))
+        else:
+            files += [f for f in glob.glob(pattern) if path.isfile(f)]
+    return sorted(set(path.normpath(f) for f in files))
+
+
+# Stream name of SDS data file <name>.<index>.sds
+def streamName(filename):
+    name = path.basename(filename)[:-len(".sds")]
+    base, _, index = name.rpartition(".")
+    return base if (base != "") and index.isdigit() else name
+
+
+# Metadata of SDS data file: -y file with the same name or <name>.sds.yml in the same directory
+# (None when there is no metadata)
+def fileMeta(filename, yaml_meta):
+    name = streamName(filename)
+    meta = [m for m in yaml_meta if m["name"] == name]
+    if len(meta) != 0:
+        return meta[0]
+    yaml_file = path.join(path.dirname(filename), f"{name}.sds.yml")
+    try:
+        with open(yaml_file, "r") as file:
+            return yaml.load(file, Loader=yaml.FullLoader)["sds"]
+    except Exception:
+        return None
+
+
+# Record indexes of mask (at most LIST_SIZE), return dictionary with count and indexes
+def findings(mask, offset=0):
+    index = np.flatnonzero(mask)
+    return {"count": len(index), "records": (index[:LIST_SIZE] + offset).tolist()}
+
+
+# Timestamps in ticks as int64 with 32-bit wrap-around removed (timestamps decreasing by more than half of the
+# timestamp range continue after the wrap, smaller decreases are kept as out-of-order timestamps)
+def unwrap(timestamp):
+    ts = timestamp.astype(np.int64)
+    if (len(ts) < 2) or (int(ts.max()) >= TIMESTAMP_RANGE):
+        return ts
+    step = np.diff(ts)
+    wrap = np.concatenate(([0], np.cumsum(step < -(TIMESTAMP_RANGE // 2))))
+    return ts + (wrap * TIMESTAMP_RANGE)
+
+
+# Analyze records of one recording, return report dictionary
+#   records:   RecordFile
+#   meta_data: metadata (None: sample size and frequency are unknown, intervals are checked in bytes)
+def analyze(records, meta_data, args):
+    tick_frequency = meta_data.get("tick-frequency", 1000) if meta_data is not None else 1000
+    ticks      = unwrap(records.timestamp)
+    data_size  = records.data_size.astype(np.int64)
+    count      = len(ticks)
+    total_size = int(data_size.sum())
+
+    report = {
+        "metadata":       meta_data is not None,
+        "records":        count,
+        "bytes":          total_size,
+        "tick_frequency": tick_frequency,
+        "first_tick":     int(ticks[0])  if count else None,
+        "last_tick":      int(ticks[-1]) if count else None,
+        "duration":       float(ticks[-1] - ticks[0]) / tick_frequency if count else 0.0
+    }
+    issues = []
+
+    # Record sizes: whole samples per record
+    sample_size = None
+    if meta_data is not None:
+        sample_size = sds_data.sampleDtype(meta_data["content"]).itemsize
+        partial = (data_size % sample_size) != 0
+        report["sample_size"]     = sample_size
+        report["samples"]         = int(np.sum(data_size // sample_size))
+        report["partial_samples"] = findings(partial)
+        if report["partial_samples"]["count"]:
+            issues.append(f"{report['partial_samples']['count']} record(s) with size not a multiple of sample size")
+    samples = (data_size // sample_size) if sample_size else data_size
+
+    # Timestamp order: equal and decreasing timestamps of consecutive records
+    step = np.diff(ticks)
+    report["duplicates"]   = findings(step == 0, 1)
+    report["out_of_order"] = findings(step < 0, 1)
+    if report["duplicates"]["count"]:
+        issues.append(f"{report['duplicates']['count']} duplicate timestamp(s)")
+    if report["out_of_order"]["count"]:
+        issues.append(f"{report['out_of_order']['count']} out-of-order timestamp(s)")
+
+    # Sample rate: measured against metadata frequency (data rate in bytes/s without metadata)
+    timestamp = ticks / tick_frequency
+    measured  = sds_timing.sampleRate(timestamp, samples)
+    rate = {"unit": "samples/s" if sample_size else "bytes/s", "measured": measured}
+    if meta_data is not None:
+        frequency = meta_data["frequency"]
+        rate["frequency"] = frequency
+        rate["deviation"] = ((measured - frequency) / frequency) if (measured is not None) and frequency else None
+        if (rate["deviation"] is not None) and (abs(rate["deviation"]) * 100 > args.tolerance):
+            issues.append(f"Sample rate {measured:.6g} Hz deviates {rate['deviation'] * 100:+.2f}% "
+                          f"from frequency {frequency} Hz")
+    report["rate"] = rate
+
+    # Data rate over time: bytes per interval of args.interval seconds from the first record
+    if count:
+        window = np.maximum((timestamp - timestamp[0]) // args.interval, 0).astype(np.int64)
+        per_window = np.bincount(window, weights=data_size, minlength=int(window.max()) + 1)
+        report["data_rate"] = {"interval": args.interval, "bytes_per_second": (per_window / args.interval).tolist()}
+
+    # Record intervals: gaps and bursts, jitter against the interval expected from the samples of the record at the
+    # rate of the regular intervals (gaps, bursts and intervals of duplicate or out-of-order timestamps are excluded)
+    gap, burst = sds_timing.irregular(timestamp, samples, 1 / tick_frequency, measured)
+    burst &= step > 0
+    report["gaps"]   = findings(gap, 1)
+    report["bursts"] = findings(burst, 1)
+    if report["gaps"]["count"]:
+        report["gaps"]["spans"] = sds_timing.spans(gap, timestamp[:-1], timestamp[1:])[:LIST_SIZE].tolist()
+        issues.append(f"{report['gaps']['count']} gap(s)")
+    if report["bursts"]["count"]:
+        report["bursts"]["spans"] = sds_timing.spans(burst, timestamp[:-1], timestamp[1:])[:LIST_SIZE].tolist()
+        issues.append(f"{report['bursts']['count']} burst(s)")
+
+    if measured is not None:
+        interval = np.diff(timestamp)
+        regular  = ~(gap | burst) & (step > 0)
+        interval = interval[regular]
+        expected = samples[:-1][regular]
+        if np.sum(expected) > 0:
+            jitter = interval - (expected * (np.sum(interval) / np.sum(expected)))
+            counts, edges = np.histogram(jitter, bins=args.bins)
+            report["jitter"] = {
+                "mean":      float(np.mean(jitter)),
+                "std":       float(np.std(jitter)),
+                "min":       float(np.min(jitter)),
+                "max":       float(np.max(jitter)),
+                "histogram": {"edges": edges.tolist(), "counts": counts.tolist()}
+            }
+
+    # Records damaged or lost (extended record header)
+    if records.summary != "":
+        report["damage"] = records.summary
+        issues.append(records.summary)
+
+    report["issues"] = issues
+    return report
+
+
+# Analyze SDS data file or streams of container file, return list of reports
+def analyzeFile(filename, yaml_meta, args):
+    reports = []
+    try:
+        file = open(filename, "rb")
+    except OSError as e:
+        return [{"file": filename, "error": str(e), "issues": [str(e)]}]
+
+    with file:
+        if sds_container.isContainer(file):
+            try:
+                container = sds_container.ContainerReader(file)
+            except sds_container.ContainerError as e:
+                return [{"file": filename, "error": str(e), "issues": [str(e)]}]
+            for stream in container.streams:
+                if (args.stream is not None) and (stream.name not in args.stream):
+                    continue
+                meta = [m for m in yaml_meta if m["name"] == stream.name]
+                if len(meta) != 0:
+                    meta_data = meta[0]
+                elif stream.metadata != "":
+                    meta_data = yaml.load(stream.metadata, Loader=yaml.FullLoader)["sds"]
+                else:
+                    meta_data = None
+                records = sds_data.RecordFile(container.open(stream))
+                reports.append({"file": filename, "stream": stream.name, **analyze(records, meta_data, args)})
+                records.close()
+        else:
+            meta_data = fileMeta(filename, yaml_meta)
+            records   = sds_data.RecordFile(file)
+            reports.append({"file": filename, "stream": streamName(filename), **analyze(records, meta_data, args)})
+            records.close()
+
+    return reports
+
+
+# Main function
+def main():
+    formatter = lambda prog: argparse.HelpFormatter(prog,max_help_position=60)
+    parser = argparse.ArgumentParser(description="Analyze SDS data recordings (timing and integrity report in JSON format)",
+                                     formatter_class=formatter)
+
+    required = parser.add_argument_group("required")
+    required.add_argument("-s", dest="sds", metavar="<sds_file>",
+                            help="SDS data recording file, container file, directory or glob pattern", nargs="+", required=True)
+
+    optional = parser.add_argument_group("optional")
+    optional.add_argument("-y", dest="yaml", metavar="<yaml_file>",
+                            help="YAML sensor description file (default: <name>.sds.yml next to each SDS data recording file)",
+                            nargs="+", default=[])
+    optional.add_argument("-o", dest="out", metavar="<output_file>",
+                            help="JSON report file (default: standard output)", default=None)
+    optional.add_argument("--stream", dest="stream", metavar="<name>",
+                            help="Streams analyzed from container file (default: all)", nargs="+", default=None)
+    optional.add_argument("--interval", dest="interval", metavar="<interval>",
+                            help="Data rate interval in seconds (default: %(default)s)", type=float, default=1.0)
+    optional.add_argument("--bins", dest="bins", metavar="<bins>",
+                            help="Number of jitter histogram bins (default: %(default)s)", type=int, default=20)
+    optional.add_argument("--tolerance", dest="tolerance", metavar="<percent>",
+                            help="Sample rate deviation from frequency reported as issue in %% (default: %(default)s)",
+                            type=float, default=5.0)
+    optional.add_argument("--check", dest="check",
+                            help="Exit with code 1 when an issue is found", action="store_true")
+
+    args = parser.parse_args()
+
+    if not (args.interval > 0):
+        sys.exit(f"Invalid interval option: {args.interval} s")
+    if args.bins < 1:
+        sys.exit(f"Invalid bins option: {args.bins}")
+
+    # Load data from .yml file
+    yaml_meta = []
+    for filename in args.yaml:
+        try:
+            with open(filename, "r") as file:
+                yaml_meta.append(yaml.load(file, Loader=yaml.FullLoader)["sds"])
+        except Exception as e:
+            sys.exit(f"Error: {e}")
+
+    files = findFiles(args.sds)
+    if len(files) == 0:
+        sys.exit("Error: No SDS data files found")
+
+    reports = []
+    for filename in files:
+        reports += analyzeFile(filename, yaml_meta, args)
+
+    output = json.dumps({"recordings": reports}, indent=2)
+    if args.out is None:
+        print(output)
+    else:
+        try:
+            with open(args.out, "w") as file:
+                file.write(output + "\n")
+        except Exception as e:
+            sys.exit(f"Error: {e}")
+
+    if args.check and any(report["issues"] for report in reports):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
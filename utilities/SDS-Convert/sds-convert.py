@@ -18,55 +18,56 @@
 
 import argparse
 import csv
+import glob
+import itertools
+import os
+import shutil
 import sys
+import tempfile
 import wave
-from struct import calcsize, unpack
+import zipfile
+from concurrent.futures import ProcessPoolExecutor, as_completed
+from functools import partial
+from os import path
+from struct import calcsize
 
 import numpy as np
 import yaml
 
+sys.path.append(path.join(path.dirname(path.abspath(__file__)), "..", "SDS-Lib"))
+import sds_align
+import sds_container
+import sds_convert
+import sds_data
+import sds_resample
 
-class RecordManager:
-    def __init__(self):
-        self.HEADER_SIZE    = 8
-        self.TIMESTAMP_SIZE = 4
-        self.data_buff      = bytearray()
-        self.timestamp      = []
-        self.data_size      = []
-
-    # Flush data buffer
-    def __flush(self):
-        self.data_buff      = bytearray()
-        self.timestamp      = []
-        self.data_size      = []
-
-    # Private function for retrieving data from record
-    def __getRecord(self, file):
-        record = bytearray(file.read(self.HEADER_SIZE))
-        if len(record) == self.HEADER_SIZE:
-            self.timestamp.append(unpack("I", record[:self.TIMESTAMP_SIZE])[0])
-            self.data_size.append(unpack("I", record[self.TIMESTAMP_SIZE:])[0])
-            self.data_buff.extend(bytearray(file.read(self.data_size[-1])))
-
-    # Extract all data from .sds recording and return a dictionary
-    # Dictionary consists of: timestamp, data_size, raw_data
-    def getData(self, file):
-        record_num = 0
-
-        while True:
-            self.__getRecord(file)
-            if len(self.timestamp) == record_num:
-                break
-            else:
-                record_num += 1
 
-        data = {"timestamp" : self.timestamp, \
-                "data_size" : self.data_size, \
-                "raw_data" : self.data_buff}
+# Return file positioned at start of records
+def rewind(file):
+    file.seek(0)
+    return file
+
 
-        self.__flush()
+# SDS recording (.sds file or stream of container file) read in record batches with bounded memory
+class Stream:
+    def __init__(self, open_file, tick_frequency=1000):
+        self.open_file      = open_file     # Function returning file object positioned at start of records
+        self.tick_frequency = tick_frequency
+        self.reported       = False         # Damage summary printed
 
-        return data
+    # Iterate record batches, yield tuple (timestamp [ms], data_size, data) for each batch
+    def batches(self):
+        file    = self.open_file()
+        batches = sds_data.RecordBatches(file)
+        for timestamp, data_size, data in batches:
+            # Convert timestamps from tick-frequency to [ms]
+            if self.tick_frequency != 1000:
+                timestamp = timestamp * 1000 / self.tick_frequency
+            yield timestamp, data_size, data
+
+        if (batches.summary != "") and not self.reported:
+            print(f"{file.name}: {batches.summary}")
+            self.reported = True
 
 
 # Convert C style data type to Python style
@@ -152,50 +153,34 @@ def createWAV(filename):
     except Exception as e:
         sys.exit(f"Error: {e}")
 
-def prepareData(meta_data, raw_data, data_manipulation):
-    sensor_data = []
-    desc_n_max = len(meta_data)
-    desc_n = 0
-    for channel in meta_data:
-        tmp_data = []
-        # Extract channel data type information from YAML file
-        d_type = getDataType(channel["type"])
-        # Calculate number of bytes needed for decoding the data in .sds file
-        d_byte = calcsize(d_type)
-        # Disunite raw data into a list of data points according to the number
-        # of bytes needed for each data point
-        tmp_data = [raw_data[i:(i + d_byte)] for i in range(0, len(raw_data), d_byte)]
-        # Keep only every n-th data point
-        tmp_data = tmp_data[desc_n::desc_n_max]
-        # Decode retrieved data points
-        tmp_data = list(unpack(f"{int(len(tmp_data))}{d_type}", b''.join(tmp_data)))
-        # Scale and offset data points if output format is not Qeexo V2 CSV
-        if data_manipulation == True:
-            if "scale" in channel:
-                scale = channel["scale"]
-            else:
-                scale = 1
-            if "offset" in channel:
-                offset = channel["offset"]
-            else:
-                offset = 0
-            data = [((x * scale) + offset) for x in tmp_data]
-        else:
-            data = tmp_data
-        # Store decoded data in a dictionary
-        sensor_data.append(data)
-        # Increment channel description number
-        desc_n += 1
-
-    return sensor_data
+# Qeexo sensor data of channel arrays: list of samples (list of channel values) or list of values of one channel
+def qeexoData(channels):
+    if len(channels) > 1:
+        if all(channel.dtype == channels[0].dtype for channel in channels):
+            return np.column_stack(channels).tolist()
+        return [list(sample) for sample in zip(*[channel.tolist() for channel in channels])]
+    elif len(channels) == 1:
+        return channels[0].tolist()
+    return []
+
+# Record batches with timestamps in seconds (normalized to start with 0 when selected)
+#   first: timestamp [s] subtracted when normalizing (default: timestamp of first record of stream)
+def recordBatches(args, stream, first=None):
+    for timestamp, data_size, data in stream.batches():
+        # Convert [ms] to [s]
+        timestamp = np.asarray(timestamp, dtype=np.float64) / 1000
+
+        # Normalize output timestamps
+        if args.normalize == True and len(timestamp) != 0:
+            if first is None:
+                first = timestamp[0]
+            timestamp = timestamp - first
+
+        yield timestamp, data_size, data
 
 # Write data to CSV file, simple format
 # Only supports one sensor at a time
 def writeSimpleCSV(args, data, meta_data):
-    normalize = args.normalize
-    csv_start_tick = args.start_tick
-    csv_stop_tick = args.stop_tick
-
     # Automatically generate new column for each sensor channel
     csv_header = ['timestamp']
     for channel in meta_data:
@@ -205,74 +190,12 @@ def writeSimpleCSV(args, data, meta_data):
     # Write header to CSV file
     writer.writerow(csv_header)
 
-    # Convert [ms] to [s]
-    timestamp = [t/1000 for t in data["timestamp"]]
-    data_size = data["data_size"]
-
-    cnt = 0
-    cnt_max = len(timestamp)
-
-    while True:
-        # Break while loop if end of file is reached
-        if cnt == cnt_max:
-            break
+    # Convert record batches (native converter library when available) and write CSV rows to output file
+    # when timestamps are between start/stop tick boundaries
+    for rows in sds_convert.simpleCsv(recordBatches(args, data), meta_data, args.start_tick, args.stop_tick):
+        csv_file.write(rows)
 
-        # Create a list of lists, based on the number of channels
-        record_row = [[] for i in range(0, len(meta_data))]
-
-        # Extract needed data and flush used bytes from buffer
-        raw_data  = data["raw_data"][:data_size[cnt]]
-        data["raw_data"] = data["raw_data"][data_size[cnt]:]
-
-        # Convert raw data according to description in meta data
-        record_row = prepareData(meta_data, raw_data, data_manipulation=True)
-
-        # Prepare and write CSV row to output file if record_row is not empty
-        if record_row != [[] for i in range(0, len(meta_data))]:
-            csv_timestamp = timestamp[cnt]
-            # Normalize output timestamps
-            if normalize == True:
-                csv_timestamp -= timestamp[0]
-            # Interpolate timestamps if there is more than one data point in this record
-            if len(record_row[0]) > 1:
-                # Get number of samples in this record
-                n_samples = len(record_row[0])
-
-                # Reuse previous time difference to interpolate timestamps for final record
-                if cnt == (cnt_max-1):
-                    csv_timestamp_next = csv_timestamp + (csv_timestamp - csv_timestamp_previous)
-                else:
-                    csv_timestamp_next = timestamp[cnt + 1]
-                    if normalize == True:
-                        csv_timestamp_next -= timestamp[0]
-
-                # Interpolate timestamps between current and next record, based on the number of
-                # data points in current record
-                tmp_time = np.linspace(csv_timestamp, csv_timestamp_next,  n_samples + 1)[:-1]
-                csv_timestamp_previous = csv_timestamp
-
-                # Write generated CSV row to output file
-                for t in range(0, len(tmp_time)):
-                    # If start/stop tick parameters are specified, write to output file
-                    # when timestamps are between selected boundaries
-                    if (csv_start_tick == None) or (tmp_time[t] >= csv_start_tick):
-                        if (csv_stop_tick == None) or (csv_stop_tick > tmp_time[t]):
-                            tmp_record_row = [record_row[i][t] for i in range(len(record_row))]
-                            writer.writerow([float(tmp_time[t])] + tmp_record_row)
-                        else:
-                            break
-            else:
-                # If start/stop tick parameters are specified, write to output file
-                # when timestamps are between selected boundaries
-                if (csv_start_tick == None) or (csv_timestamp >= csv_start_tick):
-                    if (csv_stop_tick == None) or (csv_stop_tick > csv_timestamp):
-                        # Write generated CSV row to output file
-                        writer.writerow([float(csv_timestamp)] + record_row[0])
-                    else:
-                        break
-            cnt += 1
-        else:
-            break
+    csv_file.close()
 
 
 # Write data to CSV file using Qeexo V2 format
@@ -290,92 +213,182 @@ def writeQeexoV2CSV(args, data, meta_data):
 
     writer.writerow(csv_header)
 
-    # Set sensor position counters to 0 and extract base timestamps for each sensor
-    cnt = {}
-    cnt_old = {}
+    # Extract base timestamps for each sensor from first record batch
+    batches = []
     timestamp_base = []
     for sensor in data:
-        cnt_old[sensor] = 0
-        cnt[sensor] = 0
-        timestamp_base.append(data[sensor]["timestamp"][0])
+        sensor_batches = data[sensor].batches()
+        batch = next(sensor_batches, None)
+        if batch is not None:
+            timestamp_base.append(batch[0][0])
+            sensor_batches = itertools.chain([batch], sensor_batches)
+        batches.append(sensor_batches)
+    if len(timestamp_base) == 0:
+        csv_file.close()
+        return
 
     # Select timestamp with lowest value and round to first next interval
-    csv_timestamp_base = (min(timestamp_base)//interval) * interval
-    csv_timestamp = csv_timestamp_base + interval
-
-    while True:
-        # Create a list of lists, based on the number of sensors
-        csv_row = [[] for i in range(0, len(data.keys()))]
-        sensor_idx = 0
-
-        for sensor in data:
-            timestamp = data[sensor]["timestamp"]
-            data_size = data[sensor]["data_size"]
-
-            # Check if end of file is reached. If it is, skip current sensor
-            # Otherwise store current position counter in cnt_old
-            if cnt[sensor] < len(timestamp):
-                cnt_old[sensor] = cnt[sensor]
-            else:
-                continue
-
-            # Increment position counter of this sensor if elapsed time in record
-            # is less than next CSV timestamp
-            while timestamp[cnt[sensor]] < csv_timestamp:
-                cnt[sensor] += 1
-                # Break while loop if end of file is reached
-                if cnt[sensor] == len(timestamp):
-                    break
-
-            # Calculate number of data bytes for current timestamp
-            n_bytes = sum(data_size[cnt_old[sensor]:cnt[sensor]])
-
-            # Extract needed data and flush used bytes from buffer
-            raw_data = data[sensor]["raw_data"][:n_bytes]
-            data[sensor]["raw_data"] = data[sensor]["raw_data"][n_bytes:]
-
-            # Convert raw data according to description in meta data
-            sensor_data = prepareData(meta_data[sensor], raw_data, data_manipulation=False)
-
-            # Group every n-th element of each channel into a list
-            csv_data = []
-            if len(sensor_data) > 1:
-                for i in range(0, len(sensor_data[0])):
-                    tmp_data = []
-                    for channel in range(0, len(sensor_data)):
-                        tmp_data.append(sensor_data[channel][i])
-                    csv_data.append(tmp_data)
-            elif len(sensor_data) == 1:
-                csv_data = sensor_data[0]
-
-            # Insert sensor data for this CSV timestamp
-            csv_row[sensor_idx] = csv_data
-            sensor_idx += 1
-
-        # Write current row into CSV file and increment CSV timestamp by one interval.
-        # If there is no data present in this row, exit while loop without writing to the file.
-        if csv_row != [[] for i in range(0, len(data.keys()))]:
-            if normalize == True:
-                tmp_csv_timestamp = csv_timestamp - csv_timestamp_base
-            else:
-                tmp_csv_timestamp = csv_timestamp
+    csv_timestamp_base = sds_align.gridBase(timestamp_base, interval)
 
-            # If start/stop tick parameters are specified, write to output file
-            # when timestamps are between selected boundaries
-            if (csv_start_tick == None) or (tmp_csv_timestamp >= csv_start_tick):
-                if (csv_stop_tick == None) or (csv_stop_tick > tmp_csv_timestamp):
-                    writer.writerow([tmp_csv_timestamp] + csv_row + [args.label])
-                else:
-                    break
-            csv_timestamp += interval
-        else:
+    for csv_timestamp, csv_row in qeexoRows(args, data, meta_data, batches, csv_timestamp_base):
+        # If there is no data present in this row, exit loop without writing to the file.
+        if all(len(sensor_data) == 0 for sensor_data in csv_row):
             break
 
+        if normalize == True:
+            tmp_csv_timestamp = csv_timestamp - csv_timestamp_base
+        else:
+            tmp_csv_timestamp = csv_timestamp
+
+        # If start/stop tick parameters are specified, write to output file
+        # when timestamps are between selected boundaries
+        if (csv_start_tick == None) or (tmp_csv_timestamp >= csv_start_tick):
+            if (csv_stop_tick == None) or (csv_stop_tick > tmp_csv_timestamp):
+                writer.writerow([tmp_csv_timestamp] + csv_row + [args.label])
+            else:
+                break
+
+    csv_file.close()
+
+# Qeexo V2 CSV rows, yield tuple (CSV timestamp, list of sensor data) for each interval
+def qeexoRows(args, data, meta_data, batches, csv_timestamp_base):
+    interval = args.interval
+
+    if args.align == "interval":
+        # Samples of all records with timestamp in interval
+        groups = [sds_align.IntervalGroups(sensor_batches, meta_data[sensor], csv_timestamp_base, interval)
+                  for sensor, sensor_batches in zip(data, batches)]
+        for k, entries in sds_align.intervals(groups):
+            # Sensors at end of data are skipped, data of following sensors moves to their column
+            csv_row = [qeexoData(entry) for entry in entries if entry is not None]
+            csv_row += [[] for i in range(len(csv_row), len(entries))]
+            yield sds_align.gridTime(csv_timestamp_base, interval, k), csv_row
+        return
+
+    # Sample at CSV timestamp (nearest sample or linear interpolation of sample values, not scaled)
+    resamplers = []
+    for sensor, sensor_batches in zip(data, batches):
+        content = [{key: value for key, value in channel.items() if key not in ("scale", "offset")}
+                   for channel in meta_data[sensor]]
+        resamplers.append(sds_align.GridResampler(sds_convert.blocks(sensor_batches, content), content, args.align))
+    for k, values, valid in sds_align.grid(resamplers, csv_timestamp_base, interval):
+        columns = []
+        for sensor_values, sensor_valid in zip(values, valid):
+            samples = qeexoData(sensor_values)
+            columns.append([sample if ok else [] for sample, ok in zip(samples, sensor_valid.tolist())])
+        for n, csv_row in enumerate(zip(*columns)):
+            yield sds_align.gridTime(csv_timestamp_base, interval, k + n), list(csv_row)
+
+# Columns of one stream: tuple (name, data type, unit) of each channel (scale and offset applied)
+def channelColumns(meta_data):
+    return [(channel["value"], sds_convert.columnDtype(channel), channel.get("unit")) for channel in meta_data]
+
+# Converted records of one stream, yield tuple (timestamps, list of channel values) for each block
+#   channels: indexes of channels converted (default: all)
+def streamBlocks(args, data, meta_data, channels=None):
+    return sds_convert.blocks(recordBatches(args, data), meta_data, args.start_tick, args.stop_tick, channels=channels)
+
+# Columns of resampled streams (channel names are prefixed with stream name for multiple streams)
+def resampledColumns(meta_data):
+    columns = []
+    for sensor in meta_data:
+        for channel in meta_data[sensor]:
+            name = channel["value"] if len(meta_data) == 1 else f"{sensor}.{channel['value']}"
+            columns.append((name, np.dtype(np.float64), channel.get("unit")))
+    return columns
+
+# Channels of all streams resampled on a uniform time grid, yield tuple (timestamps, list of channel values)
+# for chunks of grid times (NaN where a stream has no data)
+#   channels: indexes of columns returned (default: all)
+def resampledBlocks(args, data, meta_data, sensor_frequency, channels=None):
+    # Timestamps of all streams are normalized to the first record of all streams
+    first = None
+    if args.normalize == True:
+        timestamps = [batch[0][0] for batch in (next(data[sensor].batches(), None) for sensor in data)
+                      if batch is not None]
+        first = min(timestamps) / 1000 if len(timestamps) != 0 else None
+
+    resamplers = []
+    for sensor in data:
+        blocks = sds_convert.blocks(recordBatches(args, data[sensor], first), meta_data[sensor])
+        resamplers.append(sds_resample.StreamResampler(blocks, len(meta_data[sensor]), sensor_frequency[sensor],
+                                                       args.resample, args.resample_method))
+
+    for t, values in sds_resample.align(resamplers, args.resample, args.start_tick, args.stop_tick):
+        columns = [channel for stream_values in values for channel in stream_values]
+        if channels is not None:
+            columns = [columns[n] for n in channels]
+        yield t, columns
+
+# Write resampled streams to CSV file (timestamp followed by channel values of all streams)
+def writeResampledCSV(columns, blocks):
+    writer.writerow(["timestamp"] + [name for name, _, _ in columns])
+    for t, values in blocks():
+        writer.writerows(zip(t.tolist(), *[value.tolist() for value in values]))
     csv_file.close()
 
+# Write data to columnar file (Parquet or Arrow IPC), one row group/record batch per block
+# Columns: timestamp [s] and channel values (tuple (name, data type, unit) of each channel)
+#   blocks: function returning blocks of channel values (tuple (timestamps, list of channel values))
+def writeArrow(args, filename, columns, blocks):
+    try:
+        import pyarrow as pa
+        import pyarrow.ipc
+        import pyarrow.parquet
+    except ImportError:
+        sys.exit(f"Error: Output format {args.out_format} requires the pyarrow package")
+
+    fields = [pa.field("timestamp", pa.float64(), metadata={"unit": "s"})]
+    for name, dtype, unit in columns:
+        metadata = {"unit": unit} if unit is not None else None
+        fields.append(pa.field(name, pa.from_numpy_dtype(dtype), metadata=metadata))
+    schema = pa.schema(fields)
+
+    try:
+        if args.out_format == "parquet":
+            writer = pa.parquet.ParquetWriter(filename, schema)
+        else:
+            writer = pa.ipc.new_file(filename, schema)
+    except Exception as e:
+        sys.exit(f"Error: {e}")
+
+    for t, values in blocks():
+        writer.write_batch(pa.record_batch([t] + values, schema=schema))
+    writer.close()
+
+# Write data to numpy NPZ file (one array per column), columns are converted in one pass into temporary files
+# (array size is written before data) which are then copied into the NPZ file one after another
+# Columns: timestamp [s] and channel values (see writeArrow())
+def writeNPZ(args, filename, columns, blocks):
+    columns = [("timestamp", np.dtype(np.float64))] + [(name, dtype) for name, dtype, _ in columns]
+
+    try:
+        temp_files = [tempfile.TemporaryFile(dir=path.dirname(path.abspath(filename))) for _ in columns]
+    except Exception as e:
+        sys.exit(f"Error: {e}")
+
+    num_rows = 0
+    for t, values in blocks():
+        num_rows += len(t)
+        for (_, dtype), temp_file, column in zip(columns, temp_files, [t] + values):
+            temp_file.write(column.astype(dtype, copy=False).tobytes())
+
+    try:
+        npz_file = zipfile.ZipFile(filename, "w", zipfile.ZIP_STORED, allowZip64=True)
+    except Exception as e:
+        sys.exit(f"Error: {e}")
+
+    for (name, dtype), temp_file in zip(columns, temp_files):
+        with npz_file.open(f"{name}.npy", "w", force_zip64=True) as file:
+            np.lib.format.write_array_header_1_0(file, {"descr": np.lib.format.dtype_to_descr(dtype),
+                                                        "fortran_order": False, "shape": (num_rows,)})
+            temp_file.seek(0)
+            shutil.copyfileobj(temp_file, file, sds_data.BATCH_SIZE)
+        temp_file.close()
+    npz_file.close()
+
     # Create and write WAV file with parameters from metadata file
 def writeAudioWAV(framerate, data, meta_data):
-    raw_data = data["raw_data"]
     n_channels = len(meta_data)
     d_type = getDataType(meta_data[0]["type"])
     sample_width = calcsize(d_type)
@@ -384,10 +397,123 @@ def writeAudioWAV(framerate, data, meta_data):
     wave_file.setnchannels(n_channels)
     wave_file.setsampwidth(sample_width)
     wave_file.setframerate(framerate)
-    wave_file.writeframes(raw_data)
+    for _, _, raw_data in data.batches():
+        wave_file.writeframes(raw_data)
     wave_file.close()
 
 
+# Output file extension of output format
+def outputExtension(out_format):
+    if "csv" in out_format:
+        return ".csv"
+    if "wav" in out_format:
+        return ".wav"
+    return f".{out_format}"
+
+
+# Find SDS data files and container files in directories or matching glob patterns (sorted, without duplicates)
+def findFiles(patterns):
+    files = []
+    for pattern in patterns:
+        if path.isdir(pattern):
+            files += glob.glob(path.join(pattern, "*.sds")) + glob.glob(path.join(pattern, "*.sdsc"))
+        else:
+            files += [f for f in glob.glob(pattern) if path.isfile(f)]
+    return sorted(set(path.normpath(f) for f in files))
+
+
+# Stream name of SDS data file <name>.<index>.sds
+def streamName(filename):
+    name = path.basename(filename)[:-len(".sds")]
+    base, _, index = name.rpartition(".")
+    return base if (base != "") and index.isdigit() else name
+
+
+# Convert one file of batch mode to output file (written under temporary name and renamed when complete),
+# return error message or None
+def convertJob(args, filename, yaml_meta, output):
+    stem, extension = path.splitext(output)
+    args.out = f"{stem}.partial{extension}"
+    try:
+        convert(args, [filename], yaml_meta)
+        os.replace(args.out, output)
+        return None
+    except BaseException as e:
+        if path.exists(args.out):
+            os.remove(args.out)
+        if isinstance(e, SystemExit):
+            return str(e.code)
+        return f"Error: {e}"
+
+
+# Batch mode: convert SDS data files (paired with <name>.sds.yml in the same directory or -y file with the same
+# name) and container files in parallel, one output file per input file in output directory.
+# Files with output newer than input are skipped.
+def convertBatch(args, yaml_meta):
+    extension = outputExtension(args.out_format)
+    try:
+        os.makedirs(args.out, exist_ok=True)
+    except Exception as e:
+        sys.exit(f"Error: {e}")
+
+    jobs    = []
+    outputs = set()
+    skipped = 0
+    failed  = 0
+    for filename in findFiles(args.sds):
+        sources = [filename]
+        meta    = []
+        if filename.endswith(".sds"):
+            name = streamName(filename)
+            meta = [m for m in yaml_meta if m["name"] == name]
+            if len(meta) == 0:
+                yaml_file = path.join(path.dirname(filename), f"{name}.sds.yml")
+                try:
+                    with open(yaml_file, "r") as file:
+                        meta = [yaml.load(file, Loader=yaml.FullLoader)["sds"]]
+                except Exception as e:
+                    print(f"{filename}: No YAML file ({e})")
+                    failed += 1
+                    continue
+                sources.append(yaml_file)
+            elif len(args.yaml) != 0:
+                sources += args.yaml
+
+        output = path.join(args.out, path.splitext(path.basename(filename))[0] + extension)
+        if output in outputs:
+            print(f"{filename}: Duplicate output file {output}")
+            failed += 1
+            continue
+        outputs.add(output)
+
+        # Skip file when output is up to date
+        if not args.force and path.exists(output) and \
+           (path.getmtime(output) >= max(path.getmtime(source) for source in sources)):
+            skipped += 1
+            continue
+        jobs.append((filename, meta, output))
+
+    print(f"{len(jobs)} file(s) to convert, {skipped} up to date", flush=True)
+
+    converted = 0
+    if len(jobs) != 0:
+        with ProcessPoolExecutor(max_workers=args.jobs) as executor:
+            futures = {executor.submit(convertJob, args, filename, meta, output): filename
+                       for filename, meta, output in jobs}
+            for n, future in enumerate(as_completed(futures), 1):
+                error = future.result()
+                if error is None:
+                    converted += 1
+                    print(f"[{n}/{len(jobs)}] {futures[future]}", flush=True)
+                else:
+                    failed += 1
+                    print(f"[{n}/{len(jobs)}] {futures[future]}: {error}", flush=True)
+
+    print(f"Converted {converted} file(s), {skipped} up to date, {failed} failed")
+    if failed != 0:
+        sys.exit(1)
+
+
 # Main function
 def main():
     formatter = lambda prog: argparse.HelpFormatter(prog,max_help_position=60)
@@ -395,16 +521,19 @@ def main():
                                      formatter_class=formatter)
 
     required = parser.add_argument_group("required")
-    required.add_argument("-y", dest="yaml", metavar="<yaml_file>",
-                            help="YAML sensor description file", nargs="+", required=True)
     required.add_argument("-s", dest="sds", metavar="<sds_file>",
-                            help="SDS data recording file", nargs="+", required=True)
+                            help="SDS data recording file or container file (batch mode: directory or glob pattern)", nargs="+", required=True)
     required.add_argument("-o", dest="out", metavar="<output_file>",
-                            help="Output file", required=True)
-    required.add_argument("-f", dest="out_format", choices=["simple_csv", "qeexo_v2_csv", "audio_wav"],
+                            help="Output file (batch mode: output directory)", required=True)
+    required.add_argument("-f", dest="out_format", choices=["simple_csv", "qeexo_v2_csv", "audio_wav", "parquet", "arrow", "npz"],
                             help="Output data format", required=True)
 
     optional = parser.add_argument_group("optional")
+    optional.add_argument("-y", dest="yaml", metavar="<yaml_file>",
+                            help="YAML sensor description file (required for each SDS data recording file)",
+                            nargs="+", default=[])
+    optional.add_argument("--stream", dest="stream", metavar="<name>",
+                            help="Streams converted from container file (default: all)", nargs="+", default=None)
     optional.add_argument("--normalize", dest="normalize",
                             help="Normalize timestamps so they start with 0", action="store_true")
     optional.add_argument("--start-tick", dest="start_tick", metavar="<start-tick>",
@@ -415,6 +544,24 @@ def main():
                             help="Qeexo class label for sensor data (default: %(default)s)", default=None)
     optional.add_argument("--interval", dest="interval", metavar="<interval>",
                             help="Qeexo timestamp interval in ms (default: %(default)s)", type=int, default=50)
+    optional.add_argument("--align", dest="align", choices=["interval", "nearest", "linear"],
+                            help="Qeexo sensor data for timestamp: samples of interval, nearest sample or linear "
+                                 "interpolation (default: %(default)s)", default="interval")
+
+    optional.add_argument("--resample", dest="resample", metavar="<rate>",
+                            help="Resample all streams to a uniform time grid with rate in Hz (simple_csv, parquet, arrow, npz)",
+                            type=float, default=None)
+    optional.add_argument("--resample-method", dest="resample_method", choices=sds_resample.METHODS,
+                            help="Resampling method: polyphase FIR or sample-and-hold (default: FIR for streams with "
+                                 "frequency at or above rate, otherwise sample-and-hold)", default=None)
+
+    optional.add_argument("--batch", dest="batch",
+                            help="Batch mode: convert each SDS data file or container file found in -s directories or glob "
+                                 "patterns to one file in -o output directory", action="store_true")
+    optional.add_argument("-j", "--jobs", dest="jobs", metavar="<jobs>",
+                            help="Number of parallel conversions in batch mode (default: number of CPUs)", type=int, default=None)
+    optional.add_argument("--force", dest="force",
+                            help="Convert files in batch mode even if output is up to date", action="store_true")
 
     args = parser.parse_args()
 
@@ -423,35 +570,92 @@ def main():
         sys.exit(f"Invalid interval option: {args.interval} ms")
 
     # Load data from .yml file
-    sensor_name = []
-    meta_data = {}
-    sensor_frequency = {}
+    yaml_meta = []
     for filename in args.yaml:
         try:
             file = open(filename, "r")
-            yaml_data = yaml.load(file, Loader=yaml.FullLoader)["sds"]
-            sensor_name.append(yaml_data["name"])
-            sensor_frequency[sensor_name[-1]] = yaml_data["frequency"]
-            meta_data[sensor_name[-1]] = yaml_data["content"]
+            yaml_meta.append(yaml.load(file, Loader=yaml.FullLoader)["sds"])
             file.close()
         except Exception as e:
             sys.exit(f"Error: {e}")
 
-    # Load data from .sds file
-    Record = RecordManager()
-    data = {}
+    # Check resampling rate
+    if (args.resample is not None) and not (args.resample > 0):
+        sys.exit(f"Invalid resample option: {args.resample} Hz")
+
+    # Check number of parallel conversions
+    if (args.jobs is not None) and (args.jobs < 1):
+        sys.exit(f"Invalid jobs option: {args.jobs}")
+
+    if args.batch:
+        convertBatch(args, yaml_meta)
+    else:
+        convert(args, args.sds, yaml_meta)
+
+
+# Convert SDS data files or container file to output file args.out
+def convert(args, sds_files, yaml_meta):
+    # Open .sds file or container file (streams with .yml file of the same name or embedded metadata),
+    # records are read in batches during conversion
+    streams = []
+    files = []
     i = 0
-    for filename in args.sds:
+    for filename in sds_files:
         try:
             file = open(filename, "rb")
-            data[sensor_name[i]] = Record.getData(file)
-            file.close()
+            files.append(file)
+            if sds_container.isContainer(file):
+                container = sds_container.ContainerReader(file)
+                for stream in container.streams:
+                    if (args.stream is not None) and (stream.name not in args.stream):
+                        continue
+                    yaml_data = next((m for m in yaml_meta if m["name"] == stream.name), None)
+                    if yaml_data is None:
+                        if stream.metadata == "":
+                            raise Exception(f"No metadata for stream {stream.name} in {filename}")
+                        yaml_data = yaml.load(stream.metadata, Loader=yaml.FullLoader)["sds"]
+                    streams.append((yaml_data, partial(container.reader, stream)))
+            else:
+                if i >= len(yaml_meta):
+                    raise Exception(f"No YAML file for {filename}")
+                streams.append((yaml_meta[i], partial(rewind, file)))
+                i += 1
         except Exception as e:
             sys.exit(f"Error: {e}")
-        i += 1
+
+    sensor_name = []
+    meta_data = {}
+    sensor_frequency = {}
+    data = {}
+    for yaml_data, open_file in streams:
+        if yaml_data["name"] in data:
+            sys.exit(f"Error: Duplicate stream {yaml_data['name']}")
+        sensor_name.append(yaml_data["name"])
+        sensor_frequency[sensor_name[-1]] = yaml_data["frequency"]
+        meta_data[sensor_name[-1]] = yaml_data["content"]
+        data[sensor_name[-1]] = Stream(open_file, yaml_data.get("tick-frequency", 1000))
+    if len(data) == 0:
+        sys.exit("Error: No SDS data")
+
+    # Resampled streams (one table with channels of all streams)
+    if args.resample is not None:
+        if args.out_format not in ["simple_csv", "parquet", "arrow", "npz"]:
+            sys.exit(f"Resampling is not supported for {args.out_format} file format")
+        columns = resampledColumns(meta_data)
+        blocks  = partial(resampledBlocks, args, data, meta_data, sensor_frequency)
+        if args.out_format == "simple_csv":
+            createCSV(args.out.split('.csv')[0])
+            writeResampledCSV(columns, blocks)
+        else:
+            extension = f".{args.out_format}"
+            output_filename = args.out.split(extension)[0] + extension
+            if args.out_format == "npz":
+                writeNPZ(args, output_filename, columns, blocks)
+            else:
+                writeArrow(args, output_filename, columns, blocks)
 
     # CSV
-    if "csv" in args.out_format:
+    elif "csv" in args.out_format:
         output_filename = args.out.split('.csv')[0]
         createCSV(output_filename)
 
@@ -459,8 +663,8 @@ def main():
             writeQeexoV2CSV(args, data, meta_data)
         elif args.out_format == "simple_csv":
             # Only used for one sensor
-            if (len(args.yaml) > 1) or (len(args.sds) > 1):
-                sys.exit("Simple CSV file format only supports 1 metadata and 1 SDS file")
+            if len(sensor_name) > 1:
+                sys.exit("Simple CSV file format only supports 1 stream")
             writeSimpleCSV(args, data[sensor_name[0]], meta_data[sensor_name[0]])
 
     elif "wav" in args.out_format:
@@ -469,10 +673,28 @@ def main():
 
         if args.out_format == "audio_wav":
             # Only used for one sensor
-            if (len(args.yaml) > 1) or (len(args.sds) > 1):
-                sys.exit("Audio WAV file format only supports 1 metadata and 1 SDS file")
+            if len(sensor_name) > 1:
+                sys.exit("Audio WAV file format only supports 1 stream")
             writeAudioWAV(sensor_frequency[sensor_name[0]], data[sensor_name[0]], meta_data[sensor_name[0]])
 
+    # Columnar formats
+    else:
+        extension = f".{args.out_format}"
+        output_filename = args.out.split(extension)[0] + extension
+
+        # Only used for one sensor
+        if len(sensor_name) > 1:
+            sys.exit(f"{args.out_format} file format only supports 1 stream")
+        columns = channelColumns(meta_data[sensor_name[0]])
+        blocks  = partial(streamBlocks, args, data[sensor_name[0]], meta_data[sensor_name[0]])
+        if args.out_format == "npz":
+            writeNPZ(args, output_filename, columns, blocks)
+        else:
+            writeArrow(args, output_filename, columns, blocks)
+
+    for file in files:
+        file.close()
+
 
 if __name__ == "__main__":
     main()
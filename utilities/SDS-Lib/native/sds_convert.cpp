@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2023 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// SDS Converter (native core of SDS-Convert)
+//
+// Output is identical to the Python implementation of SDS-Convert:
+//  - values and timestamps are calculated with the same floating-point operations as numpy
+//    (compile without contraction of multiply and add: -ffp-contract=off)
+//  - floating-point values are formatted as shortest text that reads back as the same value (Python repr())
+//    using std::to_chars (C++17)
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "sds_convert.h"
+
+// Maximum integer value formatted without exponent (Python repr() uses exponent from 1e16)
+#define FIXED_LIMIT             1e16
+
+// Format unsigned integer, return number of characters
+static uint32_t FormatUnsigned (uint64_t value, char *buf) {
+  char     tmp[20];
+  uint32_t n = 0U;
+  uint32_t i;
+
+  do {
+    tmp[n++] = (char)('0' + (value % 10U));
+    value /= 10U;
+  } while (value != 0U);
+  for (i = 0U; i < n; i++) {
+    buf[i] = tmp[n - 1U - i];
+  }
+  return n;
+}
+
+// Format signed integer, return number of characters
+static uint32_t FormatInteger (int64_t value, char *buf) {
+  if (value < 0) {
+    buf[0] = '-';
+    return (1U + FormatUnsigned((uint64_t)0U - (uint64_t)value, &buf[1]));
+  }
+  return FormatUnsigned((uint64_t)value, buf);
+}
+
+// Format floating-point value as shortest representation which reads back as the same value
+uint32_t sdsConvertFormatFloat (double value, char *buf) {
+  char     tmp[SDS_CONVERT_VALUE_SIZE];
+  char     digits[20];
+  uint32_t num_digits = 0U;
+  uint32_t n = 0U;
+  uint32_t i;
+  int32_t  decpt;
+  char    *p;
+
+  if (std::isnan(value)) {
+    memcpy(buf, "nan", 4U);
+    return 3U;
+  }
+  if (std::isinf(value)) {
+    if (value < 0.0) {
+      memcpy(buf, "-inf", 5U);
+      return 4U;
+    }
+    memcpy(buf, "inf", 4U);
+    return 3U;
+  }
+  if (std::signbit(value)) {
+    buf[n++] = '-';
+    value = -value;
+  }
+
+  // Integer values: digits followed by ".0"
+  if ((value < FIXED_LIMIT) && (value == std::floor(value))) {
+    n += FormatUnsigned((uint64_t)value, &buf[n]);
+    memcpy(&buf[n], ".0", 3U);
+    return (n + 2U);
+  }
+
+  // Shortest digits which read back as the same value (closest to value when several exist)
+  *std::to_chars(tmp, tmp + sizeof(tmp) - 1U, value, std::chars_format::scientific).ptr = '\0';
+
+  // Split into digits (without trailing zeros) and decimal point position
+  for (p = tmp; (*p != 'e') && (*p != '\0'); p++) {
+    if ((*p >= '0') && (*p <= '9')) {
+      digits[num_digits++] = *p;
+    }
+  }
+  while ((num_digits > 1U) && (digits[num_digits - 1U] == '0')) {
+    num_digits--;
+  }
+  decpt = (int32_t)strtol(p + 1, NULL, 10) + 1;
+
+  if ((decpt <= -4) || (decpt > 16)) {
+    // Exponent format: d[.ddd]e+XX
+    buf[n++] = digits[0];
+    if (num_digits > 1U) {
+      buf[n++] = '.';
+      memcpy(&buf[n], &digits[1], num_digits - 1U);
+      n += num_digits - 1U;
+    }
+    n += (uint32_t)snprintf(&buf[n], 8U, "e%c%02d", (decpt - 1 < 0) ? '-' : '+', abs(decpt - 1));
+  } else if (decpt <= 0) {
+    // 0.000ddd
+    buf[n++] = '0';
+    buf[n++] = '.';
+    for (i = 0U; i < (uint32_t)-decpt; i++) {
+      buf[n++] = '0';
+    }
+    memcpy(&buf[n], digits, num_digits);
+    n += num_digits;
+  } else if ((uint32_t)decpt >= num_digits) {
+    // ddd000.0
+    memcpy(&buf[n], digits, num_digits);
+    n += num_digits;
+    for (i = num_digits; i < (uint32_t)decpt; i++) {
+      buf[n++] = '0';
+    }
+    buf[n++] = '.';
+    buf[n++] = '0';
+  } else {
+    // ddd.ddd
+    memcpy(&buf[n], digits, (uint32_t)decpt);
+    n += (uint32_t)decpt;
+    buf[n++] = '.';
+    memcpy(&buf[n], &digits[decpt], num_digits - (uint32_t)decpt);
+    n += num_digits - (uint32_t)decpt;
+  }
+  buf[n] = '\0';
+  return n;
+}
+
+// Load value of channel from sample as integer or floating-point value
+static void LoadValue (const sdsConvertChannel_t *channel, const uint8_t *sample, int64_t *i_val, double *f_val) {
+  const uint8_t *p = sample + channel->offset;
+  int8_t   i8;
+  uint8_t  u8;
+  int16_t  i16;
+  uint16_t u16;
+  int32_t  i32;
+  uint32_t u32;
+  float    f32;
+  double   f64;
+
+  switch (channel->type) {
+    case SDS_CONVERT_INT8:   memcpy(&i8,  p, 1U); *i_val = i8;  break;
+    case SDS_CONVERT_UINT8:  memcpy(&u8,  p, 1U); *i_val = u8;  break;
+    case SDS_CONVERT_INT16:  memcpy(&i16, p, 2U); *i_val = i16; break;
+    case SDS_CONVERT_UINT16: memcpy(&u16, p, 2U); *i_val = u16; break;
+    case SDS_CONVERT_INT32:  memcpy(&i32, p, 4U); *i_val = i32; break;
+    case SDS_CONVERT_UINT32: memcpy(&u32, p, 4U); *i_val = u32; break;
+    case SDS_CONVERT_FLOAT:  memcpy(&f32, p, 4U); *f_val = (double)f32; return;
+    case SDS_CONVERT_DOUBLE: memcpy(&f64, p, 8U); *f_val = f64;         return;
+    default:                 *i_val = 0;                               break;
+  }
+  *f_val = (double)*i_val;
+}
+
+// Format CSV row: timestamp followed by scaled values of all channels, return number of characters
+static uint32_t FormatRow (const sdsConvertCsv_t *csv, double timestamp, const uint8_t *sample, char *buf) {
+  const sdsConvertChannel_t *channel;
+  uint32_t n;
+  uint32_t ch;
+  int64_t  i_val;
+  double   f_val;
+
+  n = sdsConvertFormatFloat(timestamp, buf);
+  for (ch = 0U; ch < csv->num_channels; ch++) {
+    channel = &csv->channel[ch];
+    buf[n++] = ',';
+    i_val = 0;
+    LoadValue(channel, sample, &i_val, &f_val);
+    if (channel->integer != 0U) {
+      // Wrap around like int64 arithmetic of numpy
+      i_val = (int64_t)(((uint64_t)i_val * (uint64_t)channel->int_scale) + (uint64_t)channel->int_offset);
+      n += FormatInteger(i_val, &buf[n]);
+    } else {
+      n += sdsConvertFormatFloat((f_val * channel->scale) + channel->value_offset, &buf[n]);
+    }
+  }
+  buf[n++] = '\r';
+  buf[n++] = '\n';
+  return n;
+}
+
+// Convert records to rows of simple CSV format
+size_t sdsConvertCsv (sdsConvertCsv_t *csv, char *buf, size_t buf_size) {
+  size_t   row_size = (size_t)SDS_CONVERT_VALUE_SIZE * (csv->num_channels + 1U);
+  size_t   n = 0U;
+  uint32_t num;
+  double   timestamp, next, step, t;
+  const uint8_t *data;
+
+  while ((csv->done == 0U) && (csv->record < csv->num_records)) {
+    num  = csv->data_size[csv->record] / csv->sample_size;
+    data = csv->data + csv->data_offset;
+    timestamp = csv->timestamp[csv->record];
+
+    // Record without samples ends conversion
+    if (num == 0U) {
+      csv->done = 1U;
+      break;
+    }
+
+    if (num > 1U) {
+      // Interpolate timestamps between current and next record
+      // (previous time difference is reused for the last record of the recording)
+      if (csv->record != (csv->num_records - 1U)) {
+        next = csv->timestamp[csv->record + 1U];
+      } else if ((csv->flags & SDS_CONVERT_NEXT) != 0U) {
+        next = csv->next;
+      } else {
+        next = timestamp + (timestamp - csv->previous);
+      }
+      step = (next - timestamp) / (double)num;
+
+      for (; csv->sample < num; csv->sample++) {
+        if (step != 0.0) {
+          t = ((double)csv->sample * step) + timestamp;
+        } else {
+          t = (((double)csv->sample / (double)num) * (next - timestamp)) + timestamp;
+        }
+        if (((csv->flags & SDS_CONVERT_START) != 0U) && !(t >= csv->start)) {
+          continue;
+        }
+        // Remaining samples of this record are after stop time
+        if (((csv->flags & SDS_CONVERT_STOP) != 0U) && !(csv->stop > t)) {
+          break;
+        }
+        if ((buf_size - n) < row_size) {
+          return n;
+        }
+        n += FormatRow(csv, t, data + ((size_t)csv->sample * csv->sample_size), &buf[n]);
+      }
+      csv->previous = timestamp;
+    } else {
+      if (((csv->flags & SDS_CONVERT_START) == 0U) || (timestamp >= csv->start)) {
+        // Stop time ends conversion
+        if (((csv->flags & SDS_CONVERT_STOP) != 0U) && !(csv->stop > timestamp)) {
+          csv->done = 1U;
+          break;
+        }
+        if ((buf_size - n) < row_size) {
+          return n;
+        }
+        n += FormatRow(csv, timestamp, data, &buf[n]);
+      }
+    }
+
+    csv->data_offset += csv->data_size[csv->record];
+    csv->sample = 0U;
+    csv->record++;
+  }
+
+  return n;
+}
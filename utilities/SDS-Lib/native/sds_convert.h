@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2023 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SDS_CONVERT_H
+#define SDS_CONVERT_H
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ==== SDS Converter (native core of SDS-Convert) ====
+
+/// Value types
+#define SDS_CONVERT_INT8        0U          ///< int8_t
+#define SDS_CONVERT_UINT8       1U          ///< uint8_t
+#define SDS_CONVERT_INT16       2U          ///< int16_t
+#define SDS_CONVERT_UINT16      3U          ///< uint16_t
+#define SDS_CONVERT_INT32       4U          ///< int32_t
+#define SDS_CONVERT_UINT32      5U          ///< uint32_t
+#define SDS_CONVERT_FLOAT       6U          ///< float
+#define SDS_CONVERT_DOUBLE      7U          ///< double
+
+/// Conversion flags
+#define SDS_CONVERT_START       (1UL << 0)  ///< Start time is specified
+#define SDS_CONVERT_STOP        (1UL << 1)  ///< Stop time is specified
+#define SDS_CONVERT_NEXT        (1UL << 2)  ///< Records continue (timestamp of next record is specified)
+
+/// Maximum size of one formatted value in bytes (including separator)
+#define SDS_CONVERT_VALUE_SIZE  32U
+
+/// Channel description
+typedef struct {
+  uint32_t type;                            ///< value type (SDS_CONVERT_INT8 .. SDS_CONVERT_DOUBLE)
+  uint32_t offset;                          ///< value offset in sample in bytes
+  uint32_t integer;                         ///< 1: integer value scaled with int_scale and int_offset, 0: floating-point
+  uint32_t reserved;
+  int64_t  int_scale;                       ///< integer scale
+  int64_t  int_offset;                      ///< integer offset
+  double   scale;                           ///< floating-point scale
+  double   value_offset;                    ///< floating-point offset
+} sdsConvertChannel_t;
+
+/// Simple CSV conversion (description of a batch of records and conversion state)
+typedef struct {
+  const uint8_t             *data;          ///< sample data of all records
+  const double              *timestamp;     ///< record timestamps in seconds
+  const uint32_t            *data_size;     ///< data size of each record in bytes
+  const sdsConvertChannel_t *channel;       ///< channel descriptions
+  uint32_t                   num_records;   ///< number of records
+  uint32_t                   num_channels;  ///< number of channels
+  uint32_t                   sample_size;   ///< sample size in bytes
+  uint32_t                   flags;         ///< conversion flags (SDS_CONVERT_START, SDS_CONVERT_STOP, SDS_CONVERT_NEXT)
+  double                     start;         ///< start time in seconds (first row written at or after)
+  double                     stop;          ///< stop time in seconds (rows written before)
+  double                     next;          ///< timestamp of record following the batch (SDS_CONVERT_NEXT)
+  // Batch state (initialized to 0 for each batch)
+  uint32_t                   record;        ///< current record
+  uint32_t                   sample;        ///< current sample in record
+  uint64_t                   data_offset;   ///< data offset of current record in bytes
+  // Conversion state (kept for all batches)
+  double                     previous;      ///< timestamp of previous record with multiple samples
+                                            ///< (initialized to timestamp of first record)
+  uint32_t                   done;          ///< 1: conversion ended (stop time or record without samples)
+  uint32_t                   reserved;
+} sdsConvertCsv_t;
+
+/**
+  \fn          size_t sdsConvertCsv (sdsConvertCsv_t *csv, char *buf, size_t buf_size)
+  \brief       Convert records to rows of simple CSV format (timestamp followed by channel values).
+               Sample timestamps are interpolated between record timestamps, values are scaled.
+               Function is called repeatedly until all records of the batch are converted
+               (csv->record == csv->num_records) or csv->done is set; each call continues
+               where the previous call stopped.
+  \param[in]   csv            pointer to \ref sdsConvertCsv_t (description and state)
+  \param[out]  buf            pointer to buffer for CSV rows
+  \param[in]   buf_size       buffer size in bytes (at least SDS_CONVERT_VALUE_SIZE * (num_channels + 1))
+  \return      number of bytes in buffer
+*/
+size_t sdsConvertCsv (sdsConvertCsv_t *csv, char *buf, size_t buf_size);
+
+/**
+  \fn          uint32_t sdsConvertFormatFloat (double value, char *buf)
+  \brief       Format floating-point value as shortest representation which reads back as the same value
+               (same text as Python repr()).
+  \param[in]   value          value
+  \param[out]  buf            pointer to buffer for text (at least SDS_CONVERT_VALUE_SIZE bytes)
+  \return      number of characters (without terminating NUL)
+*/
+uint32_t sdsConvertFormatFloat (double value, char *buf);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* SDS_CONVERT_H */
@@ -0,0 +1,223 @@
+# Copyright (c) 2023 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Python SDS multi-sensor time alignment (records grouped by time interval, samples resampled to a time grid)
+#
+# Intervals of the grid start at base (a multiple of interval); interval k (k >= 1) ends at base + k * interval.
+# Record batches are tuples (timestamp, data_size, data) as read by sds_data.RecordBatches.
+
+import numpy as np
+
+import sds_data
+
+# Number of grid points resampled at once
+GRID_SIZE = 4096
+
+
+# Start of interval grid: lowest timestamp rounded down to a multiple of interval
+def gridBase(timestamps, interval):
+    return int(min(timestamps) // interval) * interval
+
+
+# End of interval k
+def gridTime(base, interval, k):
+    return base + (k * interval)
+
+
+# Interval of each record: record is assigned to the first interval which ends after the record timestamp,
+# but not before the interval of the previous record (records are consumed in order)
+#   previous: interval of the record preceding the timestamps
+def intervalIndex(timestamp, base, interval, previous=1):
+    if len(timestamp) == 0:
+        return np.empty(0, dtype=np.int64)
+
+    if timestamp.dtype.kind in "iu":
+        timestamp = timestamp.astype(np.int64)
+
+    # Estimate from division, corrected by comparing with interval ends (exact for integer grid)
+    k = np.floor((timestamp - base) / interval).astype(np.int64) + 1
+    end = gridTime(base, interval, k)
+    k += timestamp >= end
+    k -= timestamp < (end - interval)
+
+    return np.maximum.accumulate(np.maximum(k, previous))
+
+
+# Samples of one sensor grouped by interval, read from record batches when needed.
+# Samples of an interval are decoded from the data of all records in the interval.
+class IntervalGroups:
+    def __init__(self, batches, content, base, interval):
+        self.batches  = iter(batches)
+        self.content  = content
+        self.dtype    = sds_data.sampleDtype(content)
+        self.base     = base
+        self.interval = interval
+        self.previous = 1                           # Interval of last record read
+        self.pending  = np.empty(0, np.uint8)       # Data of records in interval self.previous
+        self.complete = 0                           # Intervals up to complete are decoded
+        self.taken    = 0                           # Intervals up to taken are returned by take()
+        self.records  = False                       # Records read
+        self.last     = None                        # Interval of last record (after end of data)
+        self.k        = np.empty(0, np.int64)       # Interval of each decoded sample (ascending)
+        self.values   = [np.empty(0, dtype=self.dtype[n]) for n in range(len(content))]
+
+    # Decode intervals of batches until interval k is complete
+    def fill(self, k):
+        while (self.last is None) and (self.complete < k):
+            batch = next(self.batches, None)
+            if batch is None:
+                self.__add([self.previous], [0], [len(self.pending)], self.pending)
+                self.last     = self.previous if self.records else 0
+                self.complete = np.iinfo(np.int64).max
+                break
+
+            timestamp, data_size, data = batch
+            if len(timestamp) == 0:
+                continue
+            self.records = True
+            record_k = intervalIndex(timestamp, self.base, self.interval, self.previous)
+            data     = np.concatenate((self.pending, data)) if len(self.pending) else data
+            offset   = len(self.pending) + np.cumsum(data_size, dtype=np.int64) - data_size
+
+            # Data ranges of intervals (pending data belongs to first interval of the batch when it continues)
+            first = np.flatnonzero(np.diff(record_k, prepend=self.previous - 1))
+            start = offset[first]
+            if (len(first) != 0) and (first[0] == 0) and (record_k[0] == self.previous):
+                start[0] = 0
+            group_k = record_k[first]
+            if record_k[0] != self.previous:
+                group_k = np.concatenate(([self.previous], group_k))
+                start   = np.concatenate(([0], start))
+            end = np.append(start[1:], len(data))
+
+            # Last interval of batch continues in next batch
+            self.__add(group_k[:-1], start[:-1], end[:-1], data)
+            self.pending  = data[start[-1]:]
+            self.previous = int(group_k[-1])
+            self.complete = self.previous - 1
+
+    # Decode samples of intervals from data ranges [start, end)
+    def __add(self, group_k, start, end, data):
+        size   = self.dtype.itemsize
+        start  = np.asarray(start, dtype=np.int64)
+        count  = (np.asarray(end, dtype=np.int64) - start) // size
+        total  = int(count.sum())
+        if total == 0:
+            return
+        index  = np.arange(total) - np.repeat(np.cumsum(count) - count, count)
+        offset = np.repeat(start, count) + (index * size)
+        if (offset[-1] - offset[0]) == ((total - 1) * size):
+            sample_data = data[offset[0]:offset[0] + (total * size)]
+        else:
+            sample_data = data[offset[:, None] + np.arange(size)].reshape(-1)
+
+        # Drop samples of intervals already taken
+        keep = np.searchsorted(self.k, self.taken, side="right")
+        self.k      = np.concatenate((self.k[keep:], np.repeat(np.asarray(group_k, dtype=np.int64), count)))
+        self.values = [np.concatenate((v[keep:], c)) for v, c in
+                       zip(self.values, sds_data.channels(sample_data, self.content))]
+
+    # Check if sensor data ended before interval k
+    def ended(self, k):
+        self.fill(k)
+        return (self.last is not None) and (k > self.last)
+
+    # Return list of channel arrays of samples in interval k (intervals are taken in ascending order)
+    def take(self, k):
+        self.fill(k)
+        lo = np.searchsorted(self.k, k, side="left")
+        hi = np.searchsorted(self.k, k, side="right")
+        self.taken = k
+        return [v[lo:hi] for v in self.values]
+
+
+# Align samples of multiple sensors to intervals, yield tuple (k, list of sample groups) for intervals k = 1, 2, ..
+# Sample group of a sensor is a list of channel arrays (None when sensor data ended before the interval).
+# Iteration ends when data of all sensors ended.
+def intervals(groups):
+    k = 1
+    while True:
+        entries = [None if g.ended(k) else g.take(k) for g in groups]
+        if all(entry is None for entry in entries):
+            return
+        yield k, entries
+        k += 1
+
+
+# Resample channel values at grid times (timestamps ascending), return list of channel arrays and mask of valid
+# values (grid times between first and last timestamp)
+#   method: "nearest" (value of nearest sample) or "linear" (linear interpolation)
+def resample(t, values, grid, method):
+    grid  = np.asarray(grid, dtype=np.float64)
+    valid = np.zeros(len(grid), dtype=bool)
+    if len(t) == 0:
+        return [np.zeros(len(grid), dtype=v.dtype) for v in values], valid
+    valid = (grid >= t[0]) & (grid <= t[-1])
+
+    if method == "linear":
+        return [np.interp(grid, t, v.astype(np.float64)) for v in values], valid
+
+    idx  = np.clip(np.searchsorted(t, grid), 1, max(len(t) - 1, 1))
+    prev = idx - 1
+    idx  = np.minimum(idx, len(t) - 1)
+    idx  = np.where(np.abs(grid - t[prev]) <= np.abs(t[idx] - grid), prev, idx)
+    return [v[idx] for v in values], valid
+
+
+# Samples of one sensor resampled at grid times, read from sample blocks (tuple (timestamps, list of channel
+# arrays) as yielded by sds_convert.blocks()) when needed. Grid times are requested in ascending order.
+class GridResampler:
+    def __init__(self, blocks, content, method):
+        self.blocks = iter(blocks)
+        self.method = method
+        self.t      = np.empty(0, np.float64)
+        self.values = [np.empty(0, dtype=sds_data.DATA_TYPES.get(c["type"], "<u4")) for c in content]
+        self.done   = False
+
+    # Return list of channel arrays resampled at grid times and mask of valid values
+    def at(self, grid):
+        # Read samples until samples after last grid time are available
+        while not self.done and ((len(self.t) == 0) or (self.t[-1] < grid[-1])):
+            block = next(self.blocks, None)
+            if block is None:
+                self.done = True
+                break
+            t, values = block
+            self.t      = np.concatenate((self.t, t))
+            self.values = [np.concatenate((v, c)) for v, c in zip(self.values, values)]
+
+        values, valid = resample(self.t, self.values, grid, self.method)
+
+        # Keep samples from the last sample before the last grid time
+        keep = max(int(np.searchsorted(self.t, grid[-1], side="right")) - 1, 0)
+        self.t      = self.t[keep:]
+        self.values = [v[keep:] for v in self.values]
+        return values, valid
+
+
+# Resample multiple sensors at interval ends, yield tuple (k, list of channel arrays, list of valid masks)
+# for chunks of intervals starting with k = 1. Iteration ends when data of all sensors ended.
+def grid(resamplers, base, interval, size=None):
+    if size is None:
+        size = GRID_SIZE
+    k = 1
+    while True:
+        times  = gridTime(base, interval, np.arange(k, k + size, dtype=np.int64))
+        result = [r.at(times) for r in resamplers]
+        yield k, [values for values, _ in result], [valid for _, valid in result]
+        if all(r.done and ((len(r.t) == 0) or (r.t[-1] <= times[-1])) for r in resamplers):
+            return
+        k += size
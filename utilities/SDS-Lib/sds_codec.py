@@ -0,0 +1,248 @@
+# Copyright (c) 2023 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Python SDS record codec (decoder for records compressed by the SDS Recorder)
+
+import ctypes
+import sys
+from os import path
+from struct import pack, unpack
+
+# Record data size flag: data is encoded
+ENCODED_FLAG = 0x80000000
+
+# Codec identifiers
+CODEC_NONE  = 0
+CODEC_DELTA = 1
+CODEC_LZ    = 2
+CODEC_RICE  = 3
+
+# Codec header: codec, sample size, channels, reserved, decoded size
+HEADER_SIZE = 8
+
+DELTA_GROUP_SIZE    = 16
+LZ_MIN_MATCH        = 4
+RICE_MAX_ORDER      = 4
+RICE_PARTITION_SIZE = 64
+RICE_PARAM_BITS     = 5
+RICE_MAX_PARAM      = 24
+
+
+# Native library file name (native/sds_convert.cpp built with sds/source/sds_codec.c)
+if sys.platform == "win32":
+    LIBRARY_NAME = "sds_convert.dll"
+elif sys.platform == "darwin":
+    LIBRARY_NAME = "libsds_convert.dylib"
+else:
+    LIBRARY_NAME = "libsds_convert.so"
+
+
+class CodecError(Exception):
+    pass
+
+
+# Load native library from native folder, return None when it is not built
+def loadLibrary():
+    try:
+        return ctypes.CDLL(path.join(path.dirname(path.abspath(__file__)), "native", LIBRARY_NAME))
+    except OSError:
+        return None
+
+
+# Native record decoder: sdsCodecDecode of sds/source/sds_codec.c (same decoder as used by the firmware),
+# None when the library is not built
+def _load():
+    lib = loadLibrary()
+    if (lib is None) or not hasattr(lib, "sdsCodecDecode"):
+        return None
+    lib.sdsCodecDecode.argtypes = [ctypes.c_char_p, ctypes.c_uint32, ctypes.c_char_p, ctypes.c_uint32]
+    lib.sdsCodecDecode.restype  = ctypes.c_uint32
+    return lib
+
+_lib = _load()
+
+
+# Delta + zigzag + bit-packing decoder
+def _deltaDecode(data, sample_size, channels, size):
+    num  = size // sample_size
+    mask = (1 << (8 * sample_size)) - 1
+    prev = [0] * channels
+    out  = bytearray(num * sample_size)
+    pos  = 0
+    ch   = 0
+
+    for i in range(0, num, DELTA_GROUP_SIZE):
+        cnt = min(DELTA_GROUP_SIZE, num - i)
+        if pos >= len(data):
+            raise CodecError("Truncated delta group")
+        width = data[pos]
+        pos += 1
+        n_bytes = (cnt * width + 7) // 8
+        if (width > 8 * sample_size) or (pos + n_bytes > len(data)):
+            raise CodecError("Invalid delta group")
+        bits = int.from_bytes(data[pos:pos + n_bytes], 'little')
+        pos += n_bytes
+        width_mask = (1 << width) - 1
+        for n in range(cnt):
+            val = (bits >> (n * width)) & width_mask
+            val = (prev[ch] + ((val >> 1) ^ -(val & 1))) & mask
+            prev[ch] = val
+            ch = (ch + 1) % channels
+            offset = (i + n) * sample_size
+            out[offset:offset + sample_size] = val.to_bytes(sample_size, 'little')
+
+    return out
+
+
+# LZ4 block format decoder
+def _lzDecode(data, size):
+    out = bytearray()
+    pos = 0
+
+    def length(pos, val):
+        while True:
+            if pos >= len(data):
+                raise CodecError("Truncated LZ length")
+            byte = data[pos]
+            pos += 1
+            val += byte
+            if byte != 255:
+                return pos, val
+
+    while pos < len(data):
+        token = data[pos]
+        pos += 1
+        lit_len = token >> 4
+        if lit_len == 15:
+            pos, lit_len = length(pos, lit_len)
+        out.extend(data[pos:pos + lit_len])
+        pos += lit_len
+        if pos >= len(data):
+            break
+        offset = data[pos] | (data[pos + 1] << 8)
+        pos += 2
+        match_len = token & 0x0F
+        if match_len == 15:
+            pos, match_len = length(pos, match_len)
+        match_len += LZ_MIN_MATCH
+        if (offset == 0) or (offset > len(out)):
+            raise CodecError("Invalid LZ offset")
+        start = len(out) - offset
+        for n in range(match_len):
+            out.append(out[start + n])
+
+    return out
+
+
+# Fixed linear prediction + Rice coding decoder (16-bit samples)
+def _riceDecode(data, channels, size):
+    num  = size // (2 * channels)
+    out  = [0] * (num * channels)
+    bits = format(int.from_bytes(data, 'big'), f"0{len(data) * 8}b") if len(data) else ""
+    pos  = 0
+
+    def get(n):
+        nonlocal pos
+        if pos + n > len(bits):
+            raise CodecError("Truncated Rice data")
+        val = int(bits[pos:pos + n], 2) if n else 0
+        pos += n
+        return val
+
+    for ch in range(channels):
+        order = get(3)
+        if (order > RICE_MAX_ORDER) or (order > num):
+            raise CodecError("Invalid predictor order")
+        x = [0] * num
+        for i in range(order):
+            val = get(16)
+            x[i] = val - 0x10000 if val & 0x8000 else val
+        i = order
+        while i < num:
+            k = get(RICE_PARAM_BITS)
+            if k > RICE_MAX_PARAM:
+                raise CodecError("Invalid Rice parameter")
+            for _ in range(min(RICE_PARTITION_SIZE, num - i)):
+                one = bits.find('1', pos)
+                if one < 0:
+                    raise CodecError("Truncated Rice data")
+                q = one - pos
+                pos = one + 1
+                val = (q << k) | get(k)
+                r = (val >> 1) ^ -(val & 1)
+                if order == 1:
+                    r += x[i - 1]
+                elif order == 2:
+                    r += 2 * x[i - 1] - x[i - 2]
+                elif order == 3:
+                    r += 3 * x[i - 1] - 3 * x[i - 2] + x[i - 3]
+                elif order == 4:
+                    r += 4 * x[i - 1] - 6 * x[i - 2] + 4 * x[i - 3] - x[i - 4]
+                x[i] = ((r + 0x8000) & 0xFFFF) - 0x8000
+                i += 1
+        out[ch::channels] = x
+
+    return pack(f"<{len(out)}h", *out)
+
+
+# Decode record data with native library
+def _decodeNative(data, size):
+    out = ctypes.create_string_buffer(size)
+    if (size != 0) and (_lib.sdsCodecDecode(bytes(data), len(data), out, size) != size):
+        raise CodecError("Invalid compressed data")
+    return out.raw
+
+
+# Decode record data (codec header followed by encoded data), native library when it is built
+def decode(data):
+    if len(data) < HEADER_SIZE:
+        raise CodecError("Missing codec header")
+    codec, sample_size, channels, _, size = unpack("<BBBBI", data[:HEADER_SIZE])
+    payload = data[HEADER_SIZE:]
+
+    if codec not in (CODEC_DELTA, CODEC_LZ, CODEC_RICE):
+        raise CodecError(f"Unknown codec: {codec}")
+    if _lib is not None:
+        return _decodeNative(data, size)
+
+    if codec == CODEC_DELTA:
+        if (sample_size not in (1, 2, 4)) or (channels == 0):
+            raise CodecError("Invalid delta codec header")
+        out = _deltaDecode(payload, sample_size, channels, size)
+    elif codec == CODEC_LZ:
+        out = _lzDecode(payload, size)
+    elif codec == CODEC_RICE:
+        if (sample_size != 2) or (channels == 0):
+            raise CodecError("Invalid Rice codec header")
+        out = _riceDecode(payload, channels, size)
+
+    if len(out) != size:
+        raise CodecError("Decoded size mismatch")
+    return out
+
+
+# Decoded size of record data from its codec header
+def decodedSize(data):
+    if len(data) < HEADER_SIZE:
+        raise CodecError("Missing codec header")
+    return unpack("<I", bytes(data[4:HEADER_SIZE]))[0]
+
+
+# Return record data from record data size field and data read from file
+def recordData(data_size, data):
+    if data_size & ENCODED_FLAG:
+        return decode(data)
+    return data
@@ -0,0 +1,254 @@
+# Copyright (c) 2023 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Python SDS container file (multiple streams with embedded metadata in one file)
+
+import io
+from bisect import bisect_right
+from struct import pack, unpack
+
+# File header: magic, version, header size, index offset
+MAGIC       = b"SDSC"
+VERSION     = 1
+HEADER_SIZE = 16
+
+# Chunk header: type, stream identifier, payload size
+CHUNK_HEADER_SIZE = 12
+
+# Chunk types
+CHUNK_META  = 1     # Stream declaration: name (NUL terminated) followed by metadata (YAML)
+CHUNK_DATA  = 2     # Stream data (records of a *.sds file)
+CHUNK_INDEX = 3     # Index of all preceding chunks
+
+# Index entry: chunk type, stream identifier, payload size, chunk offset
+INDEX_ENTRY_SIZE = 20
+
+# Minimum payload size of data chunks written by ContainerWriter (writes of a stream are coalesced)
+DATA_CHUNK_SIZE = 64 * 1024
+
+
+class ContainerError(Exception):
+    pass
+
+
+# Check if file is a container file (file position is not changed)
+def isContainer(file):
+    pos = file.tell()
+    magic = file.read(len(MAGIC))
+    file.seek(pos)
+    return magic == MAGIC
+
+
+class ContainerWriter:
+    def __init__(self, file):
+        self.file    = file
+        self.index   = []
+        self.offset  = HEADER_SIZE
+        self.pending = {}           # Data of each stream not yet written as chunk
+        self.file.write(MAGIC + pack("<HHQ", VERSION, HEADER_SIZE, 0))
+
+    # Write chunk and add it to the index
+    def __chunk(self, chunk_type, stream_id, payload):
+        self.index.append((chunk_type, stream_id, len(payload), self.offset))
+        self.file.write(pack("<3I", chunk_type, stream_id, len(payload)))
+        self.file.write(payload)
+        self.offset += CHUNK_HEADER_SIZE + len(payload)
+
+    # Declare stream with name and metadata (content of *.sds.yml file)
+    def addStream(self, stream_id, name, metadata=""):
+        self.__chunk(CHUNK_META, stream_id, name.encode("utf-8") + b"\0" + metadata.encode("utf-8"))
+
+    # Write pending data of stream as chunk
+    def __writePending(self, stream_id):
+        data = self.pending.pop(stream_id, None)
+        if data:
+            self.__chunk(CHUNK_DATA, stream_id, data)
+
+    # Append data to stream (written as chunk of at least DATA_CHUNK_SIZE bytes or when flushed)
+    def write(self, stream_id, data):
+        pending = self.pending.get(stream_id)
+        if pending is not None:
+            pending += data
+            data = pending
+        if len(data) >= DATA_CHUNK_SIZE:
+            self.pending.pop(stream_id, None)
+            self.__chunk(CHUNK_DATA, stream_id, data)
+        elif (len(data) != 0) and (pending is None):
+            self.pending[stream_id] = bytearray(data)
+
+    # Write pending data of stream (stream is closed)
+    def closeStream(self, stream_id):
+        self.__writePending(stream_id)
+
+    # Write pending data of all streams and flush file
+    def flush(self):
+        for stream_id in list(self.pending):
+            self.__writePending(stream_id)
+        self.file.flush()
+
+    # Write index and update its offset in the file header
+    def close(self):
+        for stream_id in list(self.pending):
+            self.__writePending(stream_id)
+        index_offset = self.offset
+        payload = b"".join(pack("<3IQ", *entry) for entry in self.index)
+        self.__chunk(CHUNK_INDEX, 0, payload)
+        self.file.seek(8)
+        self.file.write(pack("<Q", index_offset))
+        self.file.close()
+
+
+class ContainerStream:
+    def __init__(self, stream_id, name, metadata):
+        self.id       = stream_id
+        self.name     = name
+        self.metadata = metadata    # Metadata text (YAML) or empty string
+        self.chunks   = []          # (offset, size) of data payloads
+
+
+# Stream data read from chunks of container file (seekable file object without loading all data)
+class ContainerStreamFile(io.RawIOBase):
+    def __init__(self, file, chunks, name):
+        self.file   = file
+        self.chunks = chunks
+        self.name   = name
+        self.pos    = 0
+        self.starts = []            # Stream position of each chunk
+        self.size   = 0
+        for _, size in chunks:
+            self.starts.append(self.size)
+            self.size += size
+
+    def readable(self):
+        return True
+
+    def seekable(self):
+        return True
+
+    def readinto(self, buf):
+        n = 0
+        while (n < len(buf)) and (self.pos < self.size):
+            idx = bisect_right(self.starts, self.pos) - 1
+            offset, size = self.chunks[idx]
+            skip = self.pos - self.starts[idx]
+            self.file.seek(offset + skip)
+            data = self.file.read(min(len(buf) - n, size - skip))
+            if len(data) == 0:
+                break
+            buf[n:n + len(data)] = data
+            n += len(data)
+            self.pos += len(data)
+        return n
+
+    def seek(self, pos, whence=io.SEEK_SET):
+        if whence == io.SEEK_CUR:
+            pos += self.pos
+        elif whence == io.SEEK_END:
+            pos += self.size
+        self.pos = max(pos, 0)
+        return self.pos
+
+    def tell(self):
+        return self.pos
+
+
+class ContainerReader:
+    def __init__(self, file):
+        self.file    = file
+        self.streams = []           # Streams in order of declaration
+        self.indexed = False        # Chunks located by index (file was closed properly)
+
+        header = file.read(HEADER_SIZE)
+        if (len(header) < HEADER_SIZE) or (header[:4] != MAGIC):
+            raise ContainerError("Not an SDS container file")
+        version, header_size, index_offset = unpack("<HHQ", header[4:])
+        if version != VERSION:
+            raise ContainerError(f"Unsupported container version: {version}")
+
+        chunks = None
+        if index_offset != 0:
+            chunks = self.__readIndex(index_offset)
+        if chunks is None:
+            # No valid index: scan chunks (recording was not closed)
+            chunks = self.__scan(header_size)
+        else:
+            self.indexed = True
+
+        streams = {}
+        for chunk_type, stream_id, size, offset in chunks:
+            if chunk_type == CHUNK_META:
+                file.seek(offset + CHUNK_HEADER_SIZE)
+                name, _, metadata = file.read(size).partition(b"\0")
+                stream = ContainerStream(stream_id, name.decode("utf-8"), metadata.decode("utf-8"))
+                streams[stream_id] = stream
+                self.streams.append(stream)
+            elif (chunk_type == CHUNK_DATA) and (stream_id in streams):
+                streams[stream_id].chunks.append((offset + CHUNK_HEADER_SIZE, size))
+
+    # Read index chunk, return list of chunks or None when index is not valid
+    def __readIndex(self, offset):
+        self.file.seek(offset)
+        header = self.file.read(CHUNK_HEADER_SIZE)
+        if len(header) < CHUNK_HEADER_SIZE:
+            return None
+        chunk_type, _, size = unpack("<3I", header)
+        payload = self.file.read(size)
+        if (chunk_type != CHUNK_INDEX) or (len(payload) != size) or (size % INDEX_ENTRY_SIZE):
+            return None
+        return [unpack("<3IQ", payload[n:n + INDEX_ENTRY_SIZE]) for n in range(0, size, INDEX_ENTRY_SIZE)]
+
+    # Scan chunks from offset until end of file (or truncated chunk)
+    def __scan(self, offset):
+        chunks = []
+        while True:
+            self.file.seek(offset)
+            header = self.file.read(CHUNK_HEADER_SIZE)
+            if len(header) < CHUNK_HEADER_SIZE:
+                break
+            chunk_type, stream_id, size = unpack("<3I", header)
+            self.file.seek(offset + CHUNK_HEADER_SIZE + size)
+            if self.file.tell() > self.__fileSize():
+                break
+            chunks.append((chunk_type, stream_id, size, offset))
+            offset += CHUNK_HEADER_SIZE + size
+        return chunks
+
+    def __fileSize(self):
+        pos = self.file.tell()
+        self.file.seek(0, 2)
+        size = self.file.tell()
+        self.file.seek(pos)
+        return size
+
+    # Return streams with specified name
+    def find(self, name):
+        return [stream for stream in self.streams if stream.name == name]
+
+    # Return stream data (content of the equivalent *.sds file) as file object read from the container
+    # when needed (bounded memory for large streams)
+    def reader(self, stream):
+        name = f"{getattr(self.file, 'name', 'container')}:{stream.name}.{stream.id}"
+        return io.BufferedReader(ContainerStreamFile(self.file, stream.chunks, name))
+
+    # Return stream data (content of the equivalent *.sds file) as file object
+    def open(self, stream):
+        data = bytearray()
+        for offset, size in stream.chunks:
+            self.file.seek(offset)
+            data.extend(self.file.read(size))
+        file = io.BytesIO(bytes(data))
+        file.name = f"{getattr(self.file, 'name', 'container')}:{stream.name}.{stream.id}"
+        return file
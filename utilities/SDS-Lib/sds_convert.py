@@ -0,0 +1,302 @@
+# Copyright (c) 2023 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Python SDS converter core (native library native/sds_convert.cpp with numpy implementation as fallback)
+
+import csv
+import ctypes
+import io
+
+import numpy as np
+
+import sds_codec
+import sds_data
+
+# Size of output buffer filled by one call of the native library
+BUFFER_SIZE = 1024 * 1024
+
+# Value types of native library (SDS_CONVERT_INT8 .. SDS_CONVERT_DOUBLE)
+VALUE_TYPES = ["int8_t", "uint8_t", "int16_t", "uint16_t", "int32_t", "uint32_t", "float", "double"]
+
+# Conversion flags
+FLAG_START = 1 << 0
+FLAG_STOP  = 1 << 1
+FLAG_NEXT  = 1 << 2
+
+# Maximum size of one formatted value
+VALUE_SIZE = 32
+
+# Maximum number of samples in a record batch converted at once (numpy implementation)
+BLOCK_ROWS = 65536
+
+
+class Channel(ctypes.Structure):
+    _fields_ = [("type",         ctypes.c_uint32),
+                ("offset",       ctypes.c_uint32),
+                ("integer",      ctypes.c_uint32),
+                ("reserved",     ctypes.c_uint32),
+                ("int_scale",    ctypes.c_int64),
+                ("int_offset",   ctypes.c_int64),
+                ("scale",        ctypes.c_double),
+                ("value_offset", ctypes.c_double)]
+
+
+class CsvState(ctypes.Structure):
+    _fields_ = [("data",         ctypes.c_void_p),
+                ("timestamp",    ctypes.c_void_p),
+                ("data_size",    ctypes.c_void_p),
+                ("channel",      ctypes.POINTER(Channel)),
+                ("num_records",  ctypes.c_uint32),
+                ("num_channels", ctypes.c_uint32),
+                ("sample_size",  ctypes.c_uint32),
+                ("flags",        ctypes.c_uint32),
+                ("start",        ctypes.c_double),
+                ("stop",         ctypes.c_double),
+                ("next",         ctypes.c_double),
+                ("record",       ctypes.c_uint32),
+                ("sample",       ctypes.c_uint32),
+                ("data_offset",  ctypes.c_uint64),
+                ("previous",     ctypes.c_double),
+                ("done",         ctypes.c_uint32),
+                ("reserved",     ctypes.c_uint32)]
+
+
+# Load native library from native folder, return None when it is not built
+def _load():
+    lib = sds_codec.loadLibrary()
+    if lib is None:
+        return None
+    lib.sdsConvertCsv.argtypes = [ctypes.POINTER(CsvState), ctypes.c_char_p, ctypes.c_size_t]
+    lib.sdsConvertCsv.restype  = ctypes.c_size_t
+    return lib
+
+_lib = _load()
+
+
+# Check if native library is available
+def available():
+    return _lib is not None
+
+
+# Scale and offset of channel described in metadata content (default: 1 and 0)
+def scaling(channel):
+    return channel.get("scale", 1), channel.get("offset", 0)
+
+
+# Check if channel values are scaled with integer arithmetic (integer type, scale and offset)
+def integerScaling(channel):
+    scale, offset = scaling(channel)
+    return (sds_data.DATA_TYPES.get(channel["type"], "<u4")[1] in "iu") and \
+           isinstance(scale, int) and isinstance(offset, int)
+
+
+# Scale and offset channel data described in metadata content
+# (data type is kept for values which are not scaled)
+def scaleData(channel, data):
+    scale, offset = scaling(channel)
+    if isinstance(scale, int) and isinstance(offset, int) and (scale == 1) and (offset == 0):
+        return data
+    if integerScaling(channel):
+        return (data.astype(np.int64) * scale) + offset
+    return (data.astype(np.float64) * scale) + offset
+
+
+# Data type of channel values after scaling
+def columnDtype(channel):
+    return scaleData(channel, np.empty(0, dtype=sds_data.DATA_TYPES.get(channel["type"], "<u4"))).dtype
+
+
+# Iterate batches with timestamp of the record following each batch (None for the last batch)
+def _lookahead(batches):
+    batch = None
+    for timestamp, data_size, data in batches:
+        if len(timestamp) == 0:
+            continue
+        following = (np.ascontiguousarray(timestamp, dtype=np.float64),
+                     np.ascontiguousarray(data_size, dtype=np.uint32),
+                     np.ascontiguousarray(data, dtype=np.uint8))
+        if batch is not None:
+            yield batch + (following[0][0],)
+        batch = following
+    if batch is not None:
+        yield batch + (None,)
+
+
+# Convert records to simple CSV rows (timestamp followed by scaled channel values), yield text blocks.
+# Sample timestamps are interpolated between record timestamps (previous time difference is reused
+# for the last record); conversion ends with a record without samples.
+#   batches: iterable of record batches, tuple (timestamp, data_size, data):
+#              timestamp: record timestamps in seconds
+#              data_size: data size of each record in bytes
+#              data:      sample data of all records in the batch
+#   content: channel descriptions (metadata content)
+#   start:   start time in seconds (rows written at or after)
+#   stop:    stop time in seconds (rows written before)
+def simpleCsv(batches, content, start=None, stop=None):
+    if _lib is not None:
+        return _simpleCsvNative(batches, content, start, stop)
+    return _simpleCsvNumpy(batches, content, start, stop)
+
+
+def _simpleCsvNative(batches, content, start, stop):
+    dtype = sds_data.sampleDtype(content)
+
+    channels = (Channel * len(content))()
+    for n, value in enumerate(content):
+        scale, offset = scaling(value)
+        channel = channels[n]
+        channel.type   = VALUE_TYPES.index(value["type"]) if value["type"] in VALUE_TYPES else VALUE_TYPES.index("uint32_t")
+        channel.offset = dtype.fields[f"f{n}"][1]
+        if integerScaling(value):
+            channel.integer    = 1
+            channel.int_scale  = scale
+            channel.int_offset = offset
+        else:
+            channel.scale        = scale
+            channel.value_offset = offset
+
+    state = CsvState()
+    state.channel      = channels
+    state.num_channels = len(content)
+    state.sample_size  = dtype.itemsize
+    if start is not None:
+        state.flags |= FLAG_START
+        state.start  = start
+    if stop is not None:
+        state.flags |= FLAG_STOP
+        state.stop   = stop
+
+    buf = ctypes.create_string_buffer(max(BUFFER_SIZE, VALUE_SIZE * (len(content) + 1)))
+    for timestamp, data_size, data, following in _lookahead(batches):
+        if state.done:
+            break
+        if state.num_records == 0:
+            state.previous = timestamp[0]
+        state.data        = data.ctypes.data
+        state.timestamp   = timestamp.ctypes.data
+        state.data_size   = data_size.ctypes.data
+        state.num_records = len(timestamp)
+        state.record      = 0
+        state.sample      = 0
+        state.data_offset = 0
+        if following is not None:
+            state.flags |= FLAG_NEXT
+            state.next   = following
+        else:
+            state.flags &= ~FLAG_NEXT
+        while (state.record < state.num_records) and not state.done:
+            size = _lib.sdsConvertCsv(ctypes.byref(state), buf, len(buf))
+            if size != 0:
+                yield buf.raw[:size].decode("ascii")
+
+
+def _simpleCsvNumpy(batches, content, start, stop):
+    for t, values in blocks(batches, content, start, stop):
+        text   = io.StringIO()
+        writer = csv.writer(text)
+        writer.writerows(zip(t.tolist(), *[value.tolist() for value in values]))
+        yield text.getvalue()
+
+
+# Convert record batches to columns, yield tuple (timestamps, list of channel values) for each block.
+# Rows are the same as for simpleCsv() (see simpleCsv() for parameters); a block holds whole records
+# of one record batch with up to rows samples.
+#   channels: indexes of channels converted (default: all)
+def blocks(batches, content, start=None, stop=None, channels=None, rows=None):
+    if channels is None:
+        channels = range(len(content))
+    if rows is None:
+        rows = BLOCK_ROWS
+    dtype    = sds_data.sampleDtype(content)
+    previous = None     # Timestamp of last record with multiple samples
+
+    for timestamp, data_size, data, following in _lookahead(batches):
+        samples = (data_size // dtype.itemsize).astype(np.int64)
+        if previous is None:
+            previous = timestamp[0]
+
+        # Next record timestamps (previous time difference of records with multiple samples
+        # for the last record of the recording)
+        multi = np.flatnonzero(samples[:-1] > 1)
+        if len(multi):
+            previous = timestamp[multi[-1]]
+        next_timestamp = np.empty_like(timestamp)
+        next_timestamp[:-1] = timestamp[1:]
+        if following is not None:
+            next_timestamp[-1] = following
+        else:
+            next_timestamp[-1] = timestamp[-1] + (timestamp[-1] - previous)
+        if samples[-1] > 1:
+            previous = timestamp[-1]
+
+        # Records until the first record without samples
+        empty = np.flatnonzero(samples == 0)
+        num_records = int(empty[0]) if len(empty) else len(samples)
+        offset = np.cumsum(data_size[:num_records], dtype=np.int64) - data_size[:num_records]
+        total  = np.cumsum(samples[:num_records])
+
+        r0 = 0
+        while r0 < num_records:
+            r1 = max(int(np.searchsorted(total, total[r0] - samples[r0] + rows, side="right")), r0 + 1)
+            r_samples   = samples[r0:r1]
+            r_timestamp = timestamp[r0:r1]
+
+            # Record and index in record of each sample
+            first  = np.cumsum(r_samples) - r_samples
+            record = np.repeat(np.arange(r1 - r0), r_samples)
+            index  = np.arange(len(record)) - first[record]
+
+            # Interpolated timestamps (same operations as numpy.linspace)
+            delta = next_timestamp[r0:r1] - r_timestamp
+            step  = delta / r_samples
+            t = (index * step[record]) + r_timestamp[record]
+            zero = step[record] == 0
+            t[zero] = ((index[zero] / r_samples[record[zero]]) * delta[record[zero]]) + r_timestamp[record[zero]]
+            single = r_samples[record] == 1
+            t[single] = r_timestamp[record[single]]
+
+            # Rows between start and stop time
+            keep = np.ones(len(t), dtype=bool) if start is None else (t >= start)
+            end  = []
+            if stop is not None:
+                after = keep & ~(stop > t)
+                # Remaining samples of a record after stop time are skipped
+                count = np.cumsum(after)
+                keep &= (count - (count[first] - after[first])[record]) == 0
+                # Record with one sample after stop time ends conversion
+                end = np.flatnonzero(after & single)
+                if len(end):
+                    keep[end[0]:] = False
+
+            if np.any(keep):
+                # Sample data (records are not contiguous when data size is not a multiple of sample size)
+                start_offset = int(offset[r0])
+                if np.all(data_size[r0:r1] % dtype.itemsize == 0):
+                    sample_data = data[start_offset:start_offset + (len(record) * dtype.itemsize)]
+                else:
+                    sample_offset = offset[r0:r1][record] + (index * dtype.itemsize)
+                    sample_data = data[sample_offset[:, None] + np.arange(dtype.itemsize)].reshape(-1)
+                values = sds_data.channels(sample_data, content)
+                yield t[keep], [scaleData(content[n], values[n])[keep] for n in channels]
+
+            # Record with one sample after stop time ends conversion
+            if len(end):
+                return
+            r0 = r1
+
+        # Record without samples ends conversion
+        if len(empty):
+            return
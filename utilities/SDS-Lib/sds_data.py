@@ -0,0 +1,367 @@
+# Copyright (c) 2023 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Python SDS data file reader (memory-mapped, record table and sample decoding with numpy)
+
+import mmap
+from struct import unpack_from
+
+import numpy as np
+
+import sds_codec
+import sds_record
+
+# Default number of data bytes read at once by RecordBatches
+BATCH_SIZE = 1024 * 1024
+
+# Data size flags which require decoding of records (compressed data, 64-bit timestamp)
+_SIZE_FLAGS = ~sds_record.SIZE_MASK & 0xFFFFFFFF
+
+# numpy data types of value types used in metadata (content: type)
+DATA_TYPES = {
+    "int8_t"   : "<i1",
+    "uint8_t"  : "<u1",
+    "int16_t"  : "<i2",
+    "uint16_t" : "<u2",
+    "int32_t"  : "<i4",
+    "uint32_t" : "<u4",
+    "float"    : "<f4",
+    "double"   : "<f8",
+}
+
+
+# Structured sample data type from metadata content (one field per value, in order of the data file)
+def sampleDtype(content):
+    formats = []
+    for value in content:
+        data_type = DATA_TYPES.get(value["type"])
+        if data_type is None:
+            print(f"Unknown data type: {value['type']}\n")
+            data_type = "<u4"
+        formats.append(data_type)
+    return np.dtype({"names": [f"f{n}" for n in range(len(formats))], "formats": formats})
+
+
+# Decode raw data into list of channel arrays (views of one structured sample array)
+def channels(raw_data, content):
+    dtype   = sampleDtype(content)
+    samples = np.frombuffer(raw_data, dtype=dtype, count=len(raw_data) // dtype.itemsize)
+    return [samples[name] for name in dtype.names]
+
+
+# Records of equal size at pos of buffer (basic record header without flags), return structured array
+# of the run or None when there are less than two such records. The run is checked in windows of
+# doubling size, so that locating all runs of a file does not compare the rest of the file for each run.
+def _recordRun(buf, pos):
+    record_size = unpack_from("<I", buf, pos + 4)[0]
+    if (record_size == 0) or (record_size & _SIZE_FLAGS):
+        return None
+    dtype  = np.dtype([("timestamp", "<u4"), ("data_size", "<u4"), ("data", "u1", (record_size,))])
+    total  = (len(buf) - pos) // dtype.itemsize
+    count  = 0
+    window = 64
+    while count < total:
+        num      = min(window, total - count)
+        records  = np.frombuffer(buf, dtype=dtype, count=num, offset=pos + (count * dtype.itemsize))
+        mismatch = np.flatnonzero(records["data_size"] != record_size)
+        if len(mismatch):
+            count += int(mismatch[0])
+            break
+        count  += num
+        window *= 2
+    if count < 2:
+        return None
+    return np.frombuffer(buf, dtype=dtype, count=count, offset=pos)
+
+
+class RecordFile:
+    def __init__(self, file):
+        self.file      = file
+        self.summary   = ""         # Damage summary of records with extended header
+        self.__mmap    = None
+        self.__runs    = []         # (first record, number of records) of runs of equal size records
+        self.__field   = None       # Record data size fields (with flags) when records need decoding
+
+        # Map file content (file objects in memory, for example container streams, are used directly)
+        if hasattr(file, "getbuffer"):
+            buf = file.getbuffer()
+        else:
+            file.seek(0, 2)
+            if file.tell() != 0:
+                self.__mmap = mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ)
+                buf = self.__mmap
+            else:
+                buf = b""
+        self.base = np.frombuffer(buf, dtype=np.uint8)
+
+        file.seek(0)
+        reader = sds_record.RecordReader(file)
+        if reader.detect():
+            self.__locate(reader)
+        else:
+            self.__scan()
+
+    # Build record table from basic record headers. Runs of records with equal size are located in one
+    # vectorized pass, other records (different size, compressed data or 64-bit timestamp) one by one.
+    # Compressed data is not decoded (record data size is the decoded size from the codec header).
+    def __scan(self):
+        base   = self.base
+        size   = len(base)
+        header = sds_record.HEADER_SIZE
+        timestamp, data_size, offset, field = [], [], [], []
+        single = ([], [], [], [])
+        count  = 0
+        pos    = 0
+
+        def flush():
+            if single[0]:
+                timestamp.append(np.array(single[0], dtype=np.uint64))
+                data_size.append(np.array(single[1], dtype=np.uint32))
+                offset.append(np.array(single[2], dtype=np.int64))
+                field.append(np.array(single[3], dtype=np.uint32))
+                for values in single:
+                    values.clear()
+
+        while pos + header <= size:
+            records = _recordRun(base, pos)
+            if records is not None:
+                flush()
+                n = len(records)
+                timestamp.append(records["timestamp"].astype(np.uint64))
+                data_size.append(records["data_size"].copy())
+                offset.append(np.arange(n, dtype=np.int64) * records.dtype.itemsize + (pos + header))
+                field.append(data_size[-1])
+                self.__runs.append((count, n))
+                count += n
+                pos   += n * records.dtype.itemsize
+                continue
+
+            ts, record_size = unpack_from("<2I", base, pos)
+            ext = 4 if (record_size & sds_record.TIMESTAMP64_FLAG) else 0
+            end = pos + header + ext + (record_size & sds_record.SIZE_MASK)
+            if end > size:
+                break
+            if ext:
+                ts |= unpack_from("<I", base, pos + header)[0] << 32
+            single[0].append(ts)
+            single[1].append(self.__decodedSize(record_size, pos + header + ext))
+            single[2].append(pos + header + ext)
+            single[3].append(record_size)
+            count += 1
+            pos    = end
+        flush()
+
+        self.__table(timestamp, data_size, offset, field)
+
+    # Build record table from extended record headers (records with valid CRC, data is not decoded)
+    def __locate(self, reader):
+        timestamp, data_size, offset, field = [], [], [], []
+        while True:
+            record = reader.locate()
+            if record is None:
+                break
+            ts, record_size, pos = record
+            timestamp.append(ts)
+            data_size.append(self.__decodedSize(record_size, pos))
+            offset.append(pos)
+            field.append(record_size)
+        self.summary = reader.summary()
+
+        self.__table([np.array(timestamp, dtype=np.uint64)], [np.array(data_size, dtype=np.uint32)],
+                     [np.array(offset, dtype=np.int64)], [np.array(field, dtype=np.uint32)])
+
+    # Set record table from lists of arrays
+    def __table(self, timestamp, data_size, offset, field):
+        self.timestamp = np.concatenate(timestamp) if timestamp else np.empty(0, np.uint64)
+        self.data_size = np.concatenate(data_size) if data_size else np.empty(0, np.uint32)
+        self.offset    = np.concatenate(offset)    if offset    else np.empty(0, np.int64)
+        field = np.concatenate(field) if field else np.empty(0, np.uint32)
+        if np.any(field & sds_codec.ENCODED_FLAG):
+            self.__field = field
+
+    # Size of record data at file offset after decoding
+    def __decodedSize(self, record_size, offset):
+        if record_size & sds_codec.ENCODED_FLAG:
+            return sds_codec.decodedSize(self.base[offset:offset + sds_codec.HEADER_SIZE])
+        return record_size & sds_record.SIZE_MASK
+
+    # Number of records
+    def __len__(self):
+        return len(self.offset)
+
+    # Return tuple (timestamp, data) of record n (data is a view of the file content unless it is compressed)
+    def record(self, n):
+        return int(self.timestamp[n]), self.__data(n)
+
+    # Data of record n (decoded when compressed)
+    def __data(self, n):
+        offset = int(self.offset[n])
+        if (self.__field is not None) and (int(self.__field[n]) & sds_codec.ENCODED_FLAG):
+            size = int(self.__field[n]) & sds_record.SIZE_MASK
+            return np.frombuffer(bytes(sds_codec.decode(bytes(self.base[offset:offset + size]))), dtype=np.uint8)
+        return self.base[offset:offset + int(self.data_size[n])]
+
+    # Return data of records start to end (view of the file content when records are not separated by headers)
+    def __gather(self, start, end):
+        if start >= end:
+            return np.empty(0, dtype=np.uint8)
+        first = int(self.offset[start])
+        last  = int(self.offset[end - 1]) + int(self.data_size[end - 1])
+        if (self.__field is None) and ((last - first) == int(self.data_size[start:end].sum(dtype=np.int64))):
+            return self.base[first:last]
+
+        # Runs of equal size records are copied with one strided view, other records one by one
+        header = sds_record.HEADER_SIZE
+        pieces = []
+        n = start
+        for run_start, run_count in self.__runs:
+            run_end = run_start + run_count
+            if (run_end <= n) or (run_start >= end):
+                continue
+            pieces += [self.__data(i) for i in range(n, max(run_start, n))]
+            n = max(run_start, n)
+            m = min(run_end, end)
+            record_size = int(self.data_size[n])
+            records = np.lib.stride_tricks.as_strided(self.base[int(self.offset[n]):], shape=(m - n, record_size),
+                                                      strides=(record_size + header, 1), writeable=False)
+            pieces.append(records.reshape(-1))
+            n = m
+        pieces += [self.__data(i) for i in range(n, end)]
+        return np.concatenate(pieces) if len(pieces) > 1 else pieces[0]
+
+    # Return data of all records (view of the file content when records are not separated by headers)
+    def data(self):
+        return self.__gather(0, len(self.offset))
+
+    # Read records in batches of about batch_size data bytes, yield tuple (timestamp, data_size, data) for
+    # each batch (compressed records are decoded one batch at a time)
+    def batches(self, batch_size=None):
+        batch_size = BATCH_SIZE if batch_size is None else batch_size
+        end_pos    = np.cumsum(self.data_size, dtype=np.int64)
+        start = 0
+        while start < len(self.offset):
+            base_pos = int(end_pos[start - 1]) if start else 0
+            end = max(int(np.searchsorted(end_pos, base_pos + batch_size, side="right")), start + 1)
+            yield self.timestamp[start:end], self.data_size[start:end], self.__gather(start, end)
+            start = end
+
+    # Return list of channel arrays of all records decoded according to metadata content
+    def channels(self, content):
+        return channels(self.data(), content)
+
+    def __release(self):
+        self.base = None
+        if self.__mmap is not None:
+            try:
+                self.__mmap.close()
+            except BufferError:
+                # Views of the file content are still in use, mapping is released with them
+                pass
+            self.__mmap = None
+
+    def close(self):
+        self.__release()
+
+
+# Parse basic records at the beginning of buffer, return tuple (timestamp, data_size, data, number of bytes used).
+# Runs of records with equal size are located in one vectorized pass, other records
+# (different size, compressed data or 64-bit timestamp) one by one.
+def parseRecords(buf):
+    size   = len(buf)
+    header = sds_record.HEADER_SIZE
+    timestamp, data_size, data = [], [], []
+    single_ts, single_size = [], []
+    pos = 0
+
+    def flush():
+        if single_ts:
+            timestamp.append(np.array(single_ts, dtype=np.uint64))
+            data_size.append(np.array(single_size, dtype=np.uint32))
+            single_ts.clear()
+            single_size.clear()
+
+    while pos + header <= size:
+        records = _recordRun(buf, pos)
+        if records is not None:
+            flush()
+            timestamp.append(records["timestamp"].astype(np.uint64))
+            data_size.append(records["data_size"].copy())
+            data.append(records["data"].reshape(-1))
+            pos += len(records) * records.dtype.itemsize
+            continue
+
+        ts, record_size = unpack_from("<2I", buf, pos)
+        ext = 4 if (record_size & sds_record.TIMESTAMP64_FLAG) else 0
+        end = pos + header + ext + (record_size & sds_record.SIZE_MASK)
+        if end > size:
+            break
+        if ext:
+            ts |= unpack_from("<I", buf, pos + header)[0] << 32
+        record = sds_codec.recordData(record_size, bytes(buf[pos + header + ext:end]))
+        single_ts.append(ts)
+        single_size.append(len(record))
+        data.append(np.frombuffer(bytes(record), dtype=np.uint8))
+        pos = end
+    flush()
+
+    if len(timestamp) == 0:
+        return np.empty(0, np.uint64), np.empty(0, np.uint32), np.empty(0, np.uint8), pos
+    return np.concatenate(timestamp), np.concatenate(data_size), np.concatenate(data), pos
+
+
+# Read records in batches with bounded memory, yield tuple (timestamp, data_size, data) for each batch.
+# A batch holds whole records read from about batch_size bytes of the file (a record larger than
+# batch_size forms its own batch); data is the record data of all records in the batch.
+class RecordBatches:
+    def __init__(self, file, batch_size=None):
+        self.file       = file
+        self.batch_size = BATCH_SIZE if batch_size is None else batch_size
+        self.summary    = ""        # Damage summary of records with extended header (after iteration)
+
+    def __iter__(self):
+        reader = sds_record.RecordReader(self.file)
+        if reader.detect():
+            yield from self.__decoded(reader)
+            return
+
+        rest = b""
+        while True:
+            chunk = self.file.read(self.batch_size)
+            buf   = (rest + chunk) if rest else chunk
+            timestamp, data_size, data, used = parseRecords(buf)
+            if len(timestamp) != 0:
+                yield timestamp, data_size, data
+            rest = buf[used:]
+            if len(chunk) == 0:
+                break
+
+    # Read batches of decoded records (extended record header)
+    def __decoded(self, reader):
+        while True:
+            timestamp, data = [], []
+            size = 0
+            while size < self.batch_size:
+                record = reader.read()
+                if record is None:
+                    break
+                timestamp.append(record[0])
+                data.append(bytes(record[1]))
+                size += len(record[1])
+            if len(timestamp) == 0:
+                break
+            yield np.array(timestamp, dtype=np.uint64), np.array([len(d) for d in data], dtype=np.uint32), \
+                  np.frombuffer(b"".join(data), dtype=np.uint8)
+        self.summary = reader.summary()
@@ -0,0 +1,336 @@
+# Copyright (c) 2023 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Python SDS live streaming (stream data written to the SDSIO-Server published to local subscribers)
+#
+# Messages use the SDSIO request header (command, stream id, argument, data size) followed by data:
+#   OPEN:  stream opened, data: stream name, '\0', metadata (content of <name>.sds.yml, may be empty)
+#   WRITE: stream data, argument bit 0: data starts at a record boundary (previous data of the stream was dropped)
+#   CLOSE: stream closed
+# A subscriber receives OPEN of all open streams when it connects and stream data from the next record boundary.
+# Data queued for a subscriber is bounded: when a subscriber does not read fast enough its queued data is dropped
+# and its streams continue at the next record boundary.
+
+import math
+import socket
+import threading
+from collections import deque
+from struct import pack, unpack_from
+
+import numpy as np
+
+import sds_convert
+import sds_data
+import sds_record
+
+# Default TCP port of live stream publisher (local host)
+DEFAULT_PORT = 5051
+
+# Message commands
+OPEN  = 1
+CLOSE = 2
+WRITE = 3
+
+# Message header size
+HEADER_SIZE = 16
+
+# Maximum size of data queued for one subscriber
+QUEUE_SIZE = 4 * 1024 * 1024
+
+# Number of bytes received at once by a subscriber
+RECV_SIZE = 65536
+
+
+# Message with header
+def message(command, stream_id, argument=0, data=b""):
+    return pack("<4I", command, stream_id, argument, len(data)) + bytes(data)
+
+
+# Record boundaries of a stream: positions of record headers are followed through the stream data
+class RecordBoundary:
+    def __init__(self):
+        self.extended = None            # Record header format (detected with first record)
+        self.position = 0               # Stream position of data received
+        self.next     = 0               # Stream position of next record
+        self.header   = b""             # Header bytes of next record received with previous data
+
+    # Add stream data, return offset of first record starting in data (None when no record starts in data)
+    def add(self, data):
+        first = None
+        start = self.position
+        end   = start + len(data)
+        while self.next < end:
+            offset = self.next - start
+            if offset >= 0:
+                if first is None:
+                    first = offset
+                header = bytes(data[offset:offset + sds_record.EXT_HEADER_SIZE])
+            else:
+                header = self.header + bytes(data[:sds_record.EXT_HEADER_SIZE - len(self.header)])
+            if self.extended is None:
+                if len(header) < len(sds_record.EXT_SYNC):
+                    self.header = header
+                    break
+                self.extended = header[:len(sds_record.EXT_SYNC)] == sds_record.EXT_SYNC
+            size = sds_record.recordSize(header, self.extended)
+            if size is None:
+                self.header = header
+                break
+            self.header = b""
+            self.next  += size
+        self.position = end
+        return first
+
+
+# Subscriber connection of publisher
+class _Subscription:
+    def __init__(self, sock):
+        self.sock   = sock
+        self.queue  = deque()           # Messages to send (first message may be partially sent)
+        self.sent   = 0                 # Bytes of first message sent
+        self.queued = 0                 # Bytes queued
+        self.synced = set()             # Streams whose data is sent from a record boundary
+
+
+# Live stream publisher (used by SDSIO-Server, methods may be called from connection threads)
+class Publisher:
+    def __init__(self, port=DEFAULT_PORT):
+        self.port          = port
+        self.sock          = None
+        self.subscriptions = []
+        self.streams       = {}         # Stream id: (name, metadata, RecordBoundary)
+        self.lock          = threading.RLock()
+
+    # Listen for subscribers on local host
+    def open(self):
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.sock.bind(("127.0.0.1", self.port))
+        self.sock.listen()
+        self.sock.setblocking(False)
+
+    def close(self):
+        with self.lock:
+            for subscription in self.subscriptions:
+                subscription.sock.close()
+            self.subscriptions = []
+            if self.sock is not None:
+                self.sock.close()
+                self.sock = None
+
+    # Accept subscribers, send queued messages and remove closed subscribers (called from the server loop)
+    def poll(self):
+        with self.lock:
+            while True:
+                try:
+                    sock, _ = self.sock.accept()
+                except (BlockingIOError, InterruptedError):
+                    break
+                sock.setblocking(False)
+                subscription = _Subscription(sock)
+                for stream_id, (name, metadata, _) in self.streams.items():
+                    self.__queue(subscription, message(OPEN, stream_id, 0, f"{name}\0{metadata}".encode("utf-8")))
+                self.subscriptions.append(subscription)
+
+            for subscription in list(self.subscriptions):
+                try:
+                    if subscription.sock.recv(RECV_SIZE) == b"":
+                        self.__remove(subscription)
+                        continue
+                except (BlockingIOError, InterruptedError):
+                    pass
+                except OSError:
+                    self.__remove(subscription)
+                    continue
+                self.__send(subscription)
+
+    # Check if data is queued for subscribers (server loop polls more often until it is sent)
+    def pending(self):
+        with self.lock:
+            return any(subscription.queue for subscription in self.subscriptions)
+
+    # Stream opened
+    def streamOpen(self, stream_id, name, metadata=""):
+        with self.lock:
+            self.streams[stream_id] = (name, metadata, RecordBoundary())
+            self.__publish(message(OPEN, stream_id, 0, f"{name}\0{metadata}".encode("utf-8")))
+
+    # Stream data written
+    def streamWrite(self, stream_id, data):
+        with self.lock:
+            stream = self.streams.get(stream_id)
+            if stream is None:
+                return
+            boundary = stream[2].add(data)
+            for subscription in list(self.subscriptions):
+                if stream_id in subscription.synced:
+                    self.__queue(subscription, message(WRITE, stream_id, 0, data))
+                elif boundary is not None:
+                    subscription.synced.add(stream_id)
+                    self.__queue(subscription, message(WRITE, stream_id, 1, data[boundary:]))
+                self.__send(subscription)
+
+    # Stream closed
+    def streamClose(self, stream_id):
+        with self.lock:
+            if self.streams.pop(stream_id, None) is None:
+                return
+            for subscription in self.subscriptions:
+                subscription.synced.discard(stream_id)
+            self.__publish(message(CLOSE, stream_id))
+
+    def __publish(self, msg):
+        for subscription in list(self.subscriptions):
+            self.__queue(subscription, msg)
+            self.__send(subscription)
+
+    # Queue message, drop queued stream data when the queue is full (streams continue at the next record)
+    def __queue(self, subscription, msg):
+        if (subscription.queued + len(msg)) > QUEUE_SIZE:
+            head = subscription.queue.popleft() if subscription.sent else None
+            kept = [m for m in subscription.queue if unpack_from("<I", m)[0] != WRITE]
+            subscription.queue  = deque(([head] if head is not None else []) + kept)
+            subscription.queued = sum(len(m) for m in subscription.queue) - subscription.sent
+            subscription.synced.clear()
+            if unpack_from("<I", msg)[0] == WRITE:
+                return
+        subscription.queue.append(msg)
+        subscription.queued += len(msg)
+
+    # Send queued messages without blocking
+    def __send(self, subscription):
+        while subscription.queue:
+            msg = subscription.queue[0]
+            try:
+                size = subscription.sock.send(memoryview(msg)[subscription.sent:])
+            except (BlockingIOError, InterruptedError):
+                return
+            except OSError:
+                self.__remove(subscription)
+                return
+            subscription.sent   += size
+            subscription.queued -= size
+            if subscription.sent == len(msg):
+                subscription.queue.popleft()
+                subscription.sent = 0
+
+    def __remove(self, subscription):
+        subscription.sock.close()
+        if subscription in self.subscriptions:
+            self.subscriptions.remove(subscription)
+
+
+# Live stream subscriber (used by SDS-View)
+class Subscriber:
+    def __init__(self, port=DEFAULT_PORT, host="127.0.0.1"):
+        self.sock = socket.create_connection((host, port))
+        self.sock.setblocking(False)
+        self.buf  = bytearray()
+
+    # Read received messages without blocking, return list of tuple (command, stream id, argument, data)
+    # or None when the publisher closed the connection
+    def read(self):
+        closed = False
+        while True:
+            try:
+                data = self.sock.recv(RECV_SIZE)
+            except (BlockingIOError, InterruptedError):
+                break
+            except OSError:
+                data = b""
+            if data == b"":
+                closed = True
+                break
+            self.buf.extend(data)
+
+        messages = []
+        pos = 0
+        while (pos + HEADER_SIZE) <= len(self.buf):
+            command, stream_id, argument, data_size = unpack_from("<4I", self.buf, pos)
+            if (pos + HEADER_SIZE + data_size) > len(self.buf):
+                break
+            messages.append((command, stream_id, argument, bytes(self.buf[pos + HEADER_SIZE:pos + HEADER_SIZE + data_size])))
+            pos += HEADER_SIZE + data_size
+        del self.buf[:pos]
+        if closed and (len(messages) == 0):
+            return None
+        return messages
+
+    def close(self):
+        self.sock.close()
+
+
+# Samples of a live stream kept in ring buffers of scaled channel values (the last capacity samples)
+class LiveStream:
+    def __init__(self, name, meta_data, window):
+        self.name      = name
+        self.content   = meta_data["content"]
+        self.frequency = meta_data["frequency"]
+        self.dtype     = sds_data.sampleDtype(self.content)
+        self.capacity  = max(int(math.ceil(window * self.frequency)), 1)
+        self.values    = [np.zeros(self.capacity, dtype=np.float64) for _ in self.content]
+        self.count     = 0              # Number of samples received
+        self.pending   = bytearray()    # Data of incomplete record
+        self.extended  = None           # Record header format (detected with first record)
+        self.closed    = False
+
+    # Add stream data (boundary: data starts at a record boundary, incomplete record is dropped)
+    def add(self, data, boundary=False):
+        if boundary:
+            self.pending.clear()
+        self.pending.extend(data)
+        if self.extended is None:
+            if len(self.pending) < len(sds_record.EXT_SYNC):
+                return
+            self.extended = self.pending[:len(sds_record.EXT_SYNC)] == sds_record.EXT_SYNC
+
+        if self.extended:
+            records, used = sds_record.parseExtended(self.pending)
+            data_size = np.array([len(r[1]) for r in records], dtype=np.uint32)
+            data      = [bytes(r[1]) for r in records]
+        else:
+            _, data_size, data, used = sds_data.parseRecords(bytes(self.pending))
+            data = [data]
+        del self.pending[:used]
+        if len(data_size) == 0:
+            return
+
+        # Sample data of records (records are not contiguous when data size is not a multiple of sample size)
+        data = np.frombuffer(b"".join(bytes(d) for d in data), dtype=np.uint8)
+        size = self.dtype.itemsize
+        if np.any(data_size % size):
+            offset = np.cumsum(data_size, dtype=np.int64) - data_size
+            data   = np.concatenate([data[o:o + (s - (s % size))] for o, s in zip(offset.tolist(), data_size.tolist())])
+        self.__append([sds_convert.scaleData(c, v).astype(np.float64)
+                       for c, v in zip(self.content, sds_data.channels(data, self.content))])
+
+    # Append channel values to ring buffers
+    def __append(self, values):
+        count = len(values[0]) if values else 0
+        if count == 0:
+            return
+        skip  = max(count - self.capacity, 0)
+        index = (np.arange(self.count + skip, self.count + count) % self.capacity)
+        for ring, v in zip(self.values, values):
+            ring[index] = v[skip:]
+        self.count += count
+
+    # Return tuple (index of first sample, list of channel arrays) of samples in ring buffers (oldest first)
+    def samples(self):
+        size  = min(self.count, self.capacity)
+        start = self.count - size
+        index = np.arange(start, self.count) % self.capacity
+        return start, [ring[index] for ring in self.values]
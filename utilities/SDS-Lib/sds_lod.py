@@ -0,0 +1,187 @@
+# Copyright (c) 2023 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Python SDS level-of-detail pyramids (min/max decimation of channel values for plotting)
+#
+# Level 1 holds the minimum and maximum value of each bucket of FACTOR samples, level n + 1 the minimum and maximum
+# of FACTOR buckets of level n. Levels are built until a level has at most MIN_BUCKETS buckets. Values keep the data
+# type of the channel (scale and offset are applied when plotting), so a pyramid depends only on the recording.
+# With FACTOR = 16 a pyramid holds about 1/7 of the channel values; the visible part of a level is decimated further
+# when it is plotted.
+# Pyramids are cached in a file next to the recording (<file>.lod.npz, <file>.<stream>.lod.npz for container streams).
+
+import os
+
+import numpy as np
+
+# Number of samples (buckets) combined into one bucket of the next level
+FACTOR = 16
+
+# Maximum number of buckets of the coarsest level
+MIN_BUCKETS = 1024
+
+# Number of samples decimated at once
+CHUNK_SIZE = 1024 * 1024
+
+# Cache file format version
+VERSION = 1
+
+
+# Minimum and maximum of each bucket of factor values, return tuple (minimum, maximum)
+#   lo, hi: minimum and maximum values of the previous level (channel values for level 1)
+def decimate(lo, hi, factor=FACTOR):
+    size  = len(lo)
+    full  = size // factor
+    count = (size + factor - 1) // factor
+    out_lo = np.empty(count, dtype=lo.dtype)
+    out_hi = np.empty(count, dtype=hi.dtype)
+    step = max(CHUNK_SIZE // factor, 1)
+    for n in range(0, full, step):
+        end = min(n + step, full)
+        out_lo[n:end] = lo[n * factor:end * factor].reshape(-1, factor).min(axis=1)
+        out_hi[n:end] = hi[n * factor:end * factor].reshape(-1, factor).max(axis=1)
+    if count > full:
+        out_lo[full] = lo[full * factor:].min()
+        out_hi[full] = hi[full * factor:].max()
+    return out_lo, out_hi
+
+
+class Pyramid:
+    def __init__(self, size, levels):
+        self.size   = size          # Number of samples
+        self.levels = levels        # List of tuple (minimum, maximum) for levels 1, 2, ..
+
+    # Build pyramid of channel values
+    @staticmethod
+    def build(values):
+        levels = []
+        lo = hi = values
+        while len(lo) > MIN_BUCKETS:
+            lo, hi = decimate(lo, hi)
+            levels.append((lo, hi))
+        return Pyramid(len(values), levels)
+
+    # Return tuple (sample positions, values) to plot samples [first, last) with about points points.
+    # Samples are returned when there are at most 2 * points, otherwise minimum and maximum of buckets of
+    # points / 2 .. points buckets (both at the bucket center, alternating): the visible buckets of the finest level
+    # with at most points * FACTOR of them (level 0: samples) are combined by a factor of the range.
+    #   values: channel values (level 0)
+    def select(self, values, first, last, points):
+        first = min(max(first, 0), self.size)
+        last  = min(max(last, first), self.size)
+        if ((last - first) <= (2 * points)) or (len(self.levels) == 0):
+            return np.arange(first, last, dtype=np.float64), values[first:last]
+
+        level = len(self.levels)
+        for n in range(len(self.levels) + 1):
+            bucket = FACTOR ** n
+            if ((last - 1) // bucket) - (first // bucket) < (points * FACTOR):
+                level = n
+                break
+        bucket = FACTOR ** level
+        count  = ((last - 1) // bucket) - (first // bucket) + 1
+        factor = (count + points - 1) // points
+        lo, hi = self.levels[level - 1] if level != 0 else (values, values)
+
+        # Buckets of the selected size are aligned to multiples of the size (stable while scrolling)
+        bucket *= factor
+        b0 = first // bucket
+        b1 = ((last - 1) // bucket) + 1
+        i0 = b0 * factor
+        i1 = min(b1 * factor, len(lo))
+        if factor > 1:
+            lo, hi = decimate(lo[i0:i1], hi[i0:i1], factor)
+        else:
+            lo, hi = lo[i0:i1], hi[i0:i1]
+
+        start  = np.arange(b0, b1, dtype=np.int64) * bucket
+        center = (start + np.minimum(start + bucket, self.size) - 1) / 2
+        x = np.repeat(center, 2)
+        y = np.empty(2 * (b1 - b0), dtype=lo.dtype)
+        y[0::2] = lo
+        y[1::2] = hi
+        return x, y
+
+
+# Cache file of pyramids of a recording file (or stream of a container file)
+def cachePath(file_name, stream=None):
+    if stream is None:
+        return f"{file_name}.lod.npz"
+    return f"{file_name}.{stream}.lod.npz"
+
+
+# Key identifying the recording a cache file was built from (file size, modification time and channel types)
+def cacheKey(file_name, content):
+    stat = os.stat(file_name)
+    types = ",".join(desc["type"] for desc in content)
+    return f"{stat.st_size}:{stat.st_mtime_ns}:{types}"
+
+
+# Load pyramids from cache file, return None when it does not exist or does not match key
+def load(cache_path, key):
+    try:
+        with np.load(cache_path, allow_pickle=False) as cache:
+            if (int(cache["version"]) != VERSION) or (str(cache["key"]) != key) or (int(cache["factor"]) != FACTOR):
+                return None
+            pyramids = []
+            for n, size in enumerate(cache["sizes"].tolist()):
+                levels = []
+                while f"c{n}_l{len(levels) + 1}_min" in cache:
+                    level = len(levels) + 1
+                    levels.append((cache[f"c{n}_l{level}_min"], cache[f"c{n}_l{level}_max"]))
+                pyramids.append(Pyramid(size, levels))
+            return pyramids
+    except (OSError, KeyError, ValueError):
+        return None
+
+
+# Save pyramids to cache file (file is replaced when it is complete; cache is skipped when it cannot be written)
+def save(cache_path, key, pyramids):
+    arrays = {"version": np.array(VERSION), "key": np.array(key), "factor": np.array(FACTOR),
+              "sizes": np.array([p.size for p in pyramids], dtype=np.int64)}
+    for n, pyramid in enumerate(pyramids):
+        for level, (lo, hi) in enumerate(pyramid.levels, 1):
+            arrays[f"c{n}_l{level}_min"] = lo
+            arrays[f"c{n}_l{level}_max"] = hi
+    partial = f"{cache_path}.partial"
+    try:
+        with open(partial, "wb") as file:
+            np.savez(file, **arrays)
+        os.replace(partial, cache_path)
+    except OSError:
+        try:
+            os.remove(partial)
+        except OSError:
+            pass
+
+
+# Return list of pyramids of channel values, read from cache file when it matches the recording
+# (built and written to the cache file otherwise)
+#   values:    list of channel arrays
+#   content:   channel descriptions (metadata content)
+#   file_name: recording file (None: pyramids are not cached)
+#   stream:    stream name of container file
+def pyramids(values, content, file_name=None, stream=None):
+    if file_name is None:
+        return [Pyramid.build(v) for v in values]
+
+    cache_path = cachePath(file_name, stream)
+    key = cacheKey(file_name, content)
+    result = load(cache_path, key)
+    if (result is None) or (len(result) != len(values)) or any(p.size != len(v) for p, v in zip(result, values)):
+        result = [Pyramid.build(v) for v in values]
+        save(cache_path, key, result)
+    return result
@@ -0,0 +1,239 @@
+# Copyright (c) 2023 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Python SDS record reader (basic and extended record header)
+
+from struct import unpack, unpack_from
+
+import sds_codec
+
+try:
+    # Optional accelerated CRC32C implementation
+    from crc32c import crc32c as _crc32c
+except ImportError:
+    _crc32c = None
+
+# Basic record header: timestamp, data size
+HEADER_SIZE = 8
+
+# Record data size flag: 32-bit timestamp high word follows record header
+TIMESTAMP64_FLAG = 0x40000000
+
+# Record data size mask (without flags)
+SIZE_MASK = 0x3FFFFFFF
+
+# Extended record header: sync, sequence, timestamp, data size, CRC32C
+EXT_HEADER_SIZE = 20
+EXT_SYNC        = b"SDSR"
+
+# Number of bytes read at once when searching for the next sync word
+RESYNC_CHUNK_SIZE = 4096
+
+# Number of bytes searched for a valid extended record when detecting the header format
+DETECT_SIZE = 65536
+
+# CRC32C (Castagnoli) lookup table (reflected polynomial 0x82F63B78)
+_crc_table = []
+for _n in range(256):
+    _crc = _n
+    for _ in range(8):
+        _crc = (_crc >> 1) ^ 0x82F63B78 if _crc & 1 else _crc >> 1
+    _crc_table.append(_crc)
+
+
+# CRC32C of data (crc: CRC of preceding data)
+def crc32c(data, crc=0):
+    if _crc32c is not None:
+        return _crc32c(data, crc)
+    crc ^= 0xFFFFFFFF
+    for byte in data:
+        crc = _crc_table[(crc ^ byte) & 0xFF] ^ (crc >> 8)
+    return crc ^ 0xFFFFFFFF
+
+
+# Size of record (header, timestamp high word and data) starting with header bytes, None when header is not complete
+#   extended: record has extended record header
+def recordSize(header, extended):
+    if extended:
+        if len(header) < EXT_HEADER_SIZE:
+            return None
+        data_size = unpack_from("<I", header, 12)[0]
+        size = EXT_HEADER_SIZE
+    else:
+        if len(header) < HEADER_SIZE:
+            return None
+        data_size = unpack_from("<I", header, 4)[0]
+        size = HEADER_SIZE
+    return size + (4 if data_size & TIMESTAMP64_FLAG else 0) + (data_size & SIZE_MASK)
+
+
+# Parse complete extended records in buffer, return tuple (list of (timestamp, data), number of bytes used).
+# Data which is not a record with valid CRC is skipped to the next sync word.
+def parseExtended(buf):
+    records = []
+    pos = 0
+    while True:
+        idx = buf.find(EXT_SYNC, pos)
+        if idx < 0:
+            return records, max(pos, len(buf) - len(EXT_SYNC) + 1)
+        pos  = idx
+        size = recordSize(buf[pos:pos + EXT_HEADER_SIZE], True)
+        if (size is None) or ((pos + size) > len(buf)):
+            return records, pos
+        header = bytes(buf[pos:pos + EXT_HEADER_SIZE])
+        _, timestamp, data_size, crc = unpack_from("<4I", header, 4)
+        data = bytes(buf[pos + EXT_HEADER_SIZE:pos + size])
+        if crc32c(data, crc32c(header[:16])) != crc:
+            pos += 1
+            continue
+        if data_size & TIMESTAMP64_FLAG:
+            timestamp |= unpack_from("<I", data)[0] << 32
+            data = data[4:]
+        records.append((timestamp, sds_codec.recordData(data_size, data)))
+        pos += size
+
+
+class RecordReader:
+    def __init__(self, file):
+        self.file          = file
+        self.extended      = None   # Record header format (detected with first record)
+        self.sequence      = 0      # Expected sequence number of next record
+        self.records_lost  = 0      # Number of records missing in sequence
+        self.bytes_skipped = 0      # Number of corrupted bytes skipped
+        self.resyncs       = 0      # Number of times the reader resynchronized
+
+    # Read extended record at current file position, return None when not valid
+    def __readExtended(self):
+        header = self.file.read(EXT_HEADER_SIZE)
+        if (len(header) < EXT_HEADER_SIZE) or (header[:4] != EXT_SYNC):
+            return None
+        sequence, timestamp, data_size, crc = unpack("<4I", header[4:])
+        size = self.__extSize(data_size) + (data_size & SIZE_MASK)
+        data = self.file.read(size)
+        if len(data) != size:
+            return None
+        if crc32c(data, crc32c(header[:16])) != crc:
+            return None
+        timestamp, data = self.__split(timestamp, data_size, data)
+        return sequence, timestamp, data_size, data
+
+    # Size of record header extension (timestamp high word)
+    @staticmethod
+    def __extSize(data_size):
+        return 4 if data_size & TIMESTAMP64_FLAG else 0
+
+    # Split record into 64-bit timestamp and data (when timestamp high word is present)
+    def __split(self, timestamp, data_size, data):
+        if data_size & TIMESTAMP64_FLAG:
+            timestamp |= unpack("<I", data[:4])[0] << 32
+            data = data[4:]
+        return timestamp, data
+
+    # Position file at next sync word at or after pos, return False at end of file (or limit)
+    def __resync(self, pos, limit=None):
+        while (limit is None) or (pos < limit):
+            self.file.seek(pos)
+            chunk = self.file.read(RESYNC_CHUNK_SIZE + len(EXT_SYNC) - 1)
+            if len(chunk) < len(EXT_SYNC):
+                return False
+            idx = chunk.find(EXT_SYNC)
+            if idx >= 0:
+                self.file.seek(pos + idx)
+                return True
+            pos += len(chunk) - len(EXT_SYNC) + 1
+        return False
+
+    # Detect record header format: extended when a record with valid CRC is found
+    # at the beginning of the file (searched further when the beginning is damaged)
+    def __detect(self):
+        start = self.file.tell()
+        pos   = start
+        self.extended = False
+        while self.__resync(pos, start + DETECT_SIZE):
+            pos = self.file.tell()
+            if self.__readExtended() is not None:
+                self.extended = True
+                break
+            pos += 1
+        self.file.seek(start)
+
+    # Detect record header format, return True for extended record header
+    def detect(self):
+        if self.extended is None:
+            self.__detect()
+        return self.extended
+
+    # Read next record without decoding its data, return tuple (timestamp, data_size, data) or None at end of file
+    def __next(self):
+        if not self.detect():
+            header = self.file.read(HEADER_SIZE)
+            if len(header) < HEADER_SIZE:
+                return None
+            timestamp, data_size = unpack("<2I", header)
+            size = self.__extSize(data_size) + (data_size & SIZE_MASK)
+            data = self.file.read(size)
+            if len(data) != size:
+                return None
+            timestamp, data = self.__split(timestamp, data_size, data)
+            return timestamp, data_size, data
+
+        # Skip corrupted data until a record with valid CRC is found
+        pos = self.file.tell()
+        if len(self.file.read(1)) == 0:
+            return None
+        self.file.seek(pos)
+        record = self.__readExtended()
+        if record is None:
+            self.resyncs += 1
+            start = pos
+            while record is None:
+                if not self.__resync(pos + 1):
+                    self.file.seek(0, 2)
+                    self.bytes_skipped += self.file.tell() - start
+                    return None
+                pos = self.file.tell()
+                record = self.__readExtended()
+            self.bytes_skipped += pos - start
+
+        sequence, timestamp, data_size, data = record
+        self.records_lost += (sequence - self.sequence) & 0xFFFFFFFF
+        self.sequence = (sequence + 1) & 0xFFFFFFFF
+        return timestamp, data_size, data
+
+    # Read next record and return tuple (timestamp, data) or None at end of file
+    # (timestamp is 64-bit when the record was written with a 64-bit timestamp)
+    def read(self):
+        record = self.__next()
+        if record is None:
+            return None
+        timestamp, data_size, data = record
+        return timestamp, sds_codec.recordData(data_size, data)
+
+    # Read next record without decoding its data, return tuple (timestamp, data_size, offset) or None at end of file
+    # (data_size: record data size field with flags, offset: file position of the record data)
+    def locate(self):
+        record = self.__next()
+        if record is None:
+            return None
+        timestamp, data_size, data = record
+        return timestamp, data_size, self.file.tell() - len(data)
+
+    # Text summary of detected damage (empty string when no damage was detected)
+    def summary(self):
+        if (self.records_lost == 0) and (self.bytes_skipped == 0):
+            return ""
+        return f"{self.records_lost} record(s) lost, {self.bytes_skipped} corrupted byte(s) skipped " \
+               f"({self.resyncs} resync(s))"
@@ -0,0 +1,214 @@
+# Copyright (c) 2023 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Python SDS resampling (uniformly sampled, time-aligned channels of sensors with different sample rates)
+#
+# Channel values are resampled at the times of a uniform grid (multiples of 1 / rate) with:
+#   fir:  polyphase FIR filter (windowed-sinc low-pass filter bank evaluated at the fractional sample position
+#         of each grid time; anti-aliasing when the sensor rate is higher than the grid rate)
+#   hold: sample-and-hold (value of the last sample at or before the grid time)
+# Sample timestamps are used to locate grid times between samples, so sample jitter is followed.
+
+import numpy as np
+
+# Resampling methods
+METHODS = ["fir", "hold"]
+
+# Number of phases (fractional sample positions) of the polyphase filter bank
+PHASES = 64
+
+# Filter length in samples (of the lower of sensor and grid rate)
+TAPS = 16
+
+# Kaiser window shape parameter
+BETA = 8.0
+
+# Filter cutoff frequency relative to the Nyquist frequency of the lower rate
+CUTOFF = 0.9
+
+# Maximum number of filter taps evaluated at once (grid times * filter length)
+FIR_BLOCK_SIZE = 1024 * 1024
+
+# Number of grid times resampled at once by align()
+GRID_SIZE = 65536
+
+
+# Grid times between start and stop time (multiples of 1 / rate)
+def grid(start, stop, rate):
+    return np.arange(np.ceil(start * rate), np.floor(stop * rate) + 1) / rate
+
+
+# Default resampling method: polyphase FIR for sensors with a rate at or above the grid rate,
+# sample-and-hold for slower sensors
+def method(frequency, rate):
+    return "fir" if frequency >= rate else "hold"
+
+
+# Polyphase filter bank for resampling from frequency to rate, return tuple (filter bank, filter length).
+# Filter bank has PHASES + 1 rows (fractional positions 0 .. 1), each with unity gain.
+def filterBank(frequency, rate):
+    scale = min(1.0, rate / frequency)
+    size  = 2 * int(np.ceil(TAPS / 2 / scale))
+    cutoff = 0.5 * scale * CUTOFF
+
+    # Distance of taps from the fractional sample position
+    d = (np.arange(size) - (size // 2) + 1)[None, :] - (np.arange(PHASES + 1) / PHASES)[:, None]
+    x = np.clip(d / (size / 2), -1.0, 1.0)
+    h = 2 * cutoff * np.sinc(2 * cutoff * d) * np.i0(BETA * np.sqrt(1.0 - (x * x))) / np.i0(BETA)
+    return h / h.sum(axis=1, keepdims=True), size
+
+
+# Resample channel values with polyphase FIR filter at grid times, return list of channel arrays
+# (samples before first and after last sample are repeated)
+def fir(t, values, times, frequency, rate):
+    bank, size = filterBank(frequency, rate)
+    values = [np.asarray(v, dtype=np.float64) for v in values]
+    result = [np.empty(len(times), dtype=np.float64) for _ in values]
+    if len(t) == 1:
+        for r, v in zip(result, values):
+            r[:] = v[0]
+        return result
+
+    # Fractional sample position of grid times
+    position = np.interp(times, t, np.arange(len(t), dtype=np.float64))
+    index    = np.floor(position).astype(np.int64)
+    phase    = np.rint((position - index) * PHASES).astype(np.int64)
+    taps     = np.arange(size) - (size // 2) + 1
+
+    block = max(1, FIR_BLOCK_SIZE // size)
+    for n in range(0, len(times), block):
+        taps_index = np.clip(index[n:n + block, None] + taps[None, :], 0, len(t) - 1)
+        h = bank[phase[n:n + block]]
+        for r, v in zip(result, values):
+            r[n:n + block] = np.einsum("mk,mk->m", h, v[taps_index])
+    return result
+
+
+# Resample channel values with sample-and-hold at grid times, return list of channel arrays
+def hold(t, values, times):
+    index = np.maximum(np.searchsorted(t, times, side="right") - 1, 0)
+    return [np.asarray(v, dtype=np.float64)[index] for v in values]
+
+
+# Resample channel values at grid times, return list of channel arrays and mask of valid values
+# (grid times from first sample to last sample, for sample-and-hold to one sample period after the last sample)
+#   t:         sample timestamps (ascending)
+#   values:    list of channel arrays
+#   times:     grid times
+#   frequency: sample rate of channels
+#   rate:      grid rate
+#   method_name: "fir", "hold" or None (default method for frequency and rate)
+def resample(t, values, times, frequency, rate, method_name=None):
+    times = np.asarray(times, dtype=np.float64)
+    if method_name is None:
+        method_name = method(frequency, rate)
+    if len(t) == 0:
+        return [np.full(len(times), np.nan) for _ in values], np.zeros(len(times), dtype=bool)
+
+    if method_name == "hold":
+        result = hold(t, values, times)
+        valid  = (times >= t[0]) & (times < (t[-1] + (1 / frequency)))
+    else:
+        result = fir(t, values, times, frequency, rate)
+        valid  = (times >= t[0]) & (times <= t[-1])
+    for r in result:
+        r[~valid] = np.nan
+    return result, valid
+
+
+# Channels of one sensor resampled at grid times, read from sample blocks (tuple (timestamps, list of channel
+# arrays) as yielded by sds_convert.blocks()) when needed. Grid times are requested in ascending order.
+class StreamResampler:
+    def __init__(self, blocks, num_channels, frequency, rate, method_name=None):
+        self.blocks    = iter(blocks)
+        self.frequency = frequency
+        self.rate      = rate
+        self.method    = method(frequency, rate) if method_name is None else method_name
+        self.margin    = filterBank(frequency, rate)[1] if self.method == "fir" else 1
+        self.t         = np.empty(0, np.float64)
+        self.values    = [np.empty(0, np.float64) for _ in range(num_channels)]
+        self.done      = False
+
+    # Read next sample block, return False at end of samples
+    def __read(self):
+        block = next(self.blocks, None) if not self.done else None
+        if block is None:
+            self.done = True
+            return False
+        t, values = block
+        self.t      = np.concatenate((self.t, t))
+        self.values = [np.concatenate((v, c)) for v, c in zip(self.values, values)]
+        return True
+
+    # Timestamp of first sample (None when there are no samples)
+    def first(self):
+        while (len(self.t) == 0) and self.__read():
+            pass
+        return self.t[0] if len(self.t) else None
+
+    # Timestamp of last sample read (after end of samples: last sample)
+    def last(self):
+        return self.t[-1] if len(self.t) else None
+
+    # Return list of channel arrays resampled at grid times and mask of valid values
+    def at(self, times):
+        # Read samples until the filter has all samples after the last grid time
+        while (len(self.t) - np.searchsorted(self.t, times[-1], side="right")) < self.margin:
+            if not self.__read():
+                break
+
+        result = resample(self.t, self.values, times, self.frequency, self.rate, self.method)
+
+        # Keep samples needed by the filter before the next grid time
+        keep = max(int(np.searchsorted(self.t, times[-1], side="right")) - self.margin, 0)
+        self.t      = self.t[keep:]
+        self.values = [v[keep:] for v in self.values]
+        return result
+
+
+# Resample sensors on a common grid, yield tuple (grid times, list of channel arrays of each sensor)
+# for chunks of grid times. Grid starts at the first sample of all sensors (or start time) and ends
+# at the last sample of all sensors (or before stop time); invalid values are NaN.
+def align(resamplers, rate, start=None, stop=None, size=None):
+    if size is None:
+        size = GRID_SIZE
+    first = [r.first() for r in resamplers]
+    first = [f for f in first if f is not None]
+    if len(first) == 0:
+        return
+    if start is None:
+        start = min(first)
+    n = int(np.ceil(start * rate))
+
+    while True:
+        times = np.arange(n, n + size) / rate
+        if stop is not None:
+            times = times[times < stop]
+        if len(times) == 0:
+            return
+        result = [r.at(times) for r in resamplers]
+
+        # Grid ends after last sample of all sensors
+        end  = len(times)
+        last = [r.last() for r in resamplers if r.last() is not None]
+        if all(r.done for r in resamplers) and (len(last) != 0):
+            end = min(end, int(np.searchsorted(times, max(last), side="right")))
+
+        if end != 0:
+            yield times[:end], [[v[:end] for v in values] for values, _ in result]
+        if end < size:
+            return
+        n += size
@@ -0,0 +1,71 @@
+# Copyright (c) 2023 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Python SDS record timing analysis (measured sample rate, gaps and bursts between record timestamps)
+#
+# Interval n is the time between the timestamps of record n and record n + 1. The expected interval is the
+# duration of the samples of record n at the measured sample rate of the recording:
+#   gap:   interval longer than GAP_FACTOR times the expected interval (samples missing, for example records
+#          dropped or the recorder stalled)
+#   burst: interval shorter than the expected interval divided by GAP_FACTOR (samples delivered faster than they
+#          are sampled, for example buffered samples read after a sensor overflow)
+# One timestamp tick is tolerated in both directions for timestamp resolution.
+
+import numpy as np
+
+# Ratio of record interval and expected interval detected as gap or burst
+GAP_FACTOR = 2.0
+
+
+# Measured sample rate in Hz: samples of all records but the last over the time from first to last record
+# (None when the rate cannot be measured)
+#   timestamp: record timestamps in seconds
+#   samples:   number of samples of each record
+def sampleRate(timestamp, samples):
+    if len(timestamp) < 2:
+        return None
+    duration = float(timestamp[-1]) - float(timestamp[0])
+    count    = int(np.sum(samples[:-1], dtype=np.int64))
+    if (duration <= 0) or (count == 0):
+        return None
+    return count / duration
+
+
+# Return tuple (gap, burst) of masks of record intervals (see module description)
+#   timestamp:  record timestamps in seconds
+#   samples:    number of samples of each record
+#   resolution: timestamp resolution in seconds (one tick)
+#   rate:       sample rate in Hz (default: measured sample rate)
+def irregular(timestamp, samples, resolution, rate=None):
+    if rate is None:
+        rate = sampleRate(timestamp, samples)
+    if (rate is None) or (len(timestamp) < 2):
+        empty = np.zeros(max(len(timestamp) - 1, 0), dtype=bool)
+        return empty, empty
+    interval = np.diff(np.asarray(timestamp, dtype=np.float64))
+    expected = np.asarray(samples[:-1], dtype=np.float64) / rate
+    gap   = interval > ((GAP_FACTOR * expected) + resolution)
+    burst = (interval * GAP_FACTOR) < (expected - resolution)
+    return gap, burst
+
+
+# Time ranges of runs of consecutive intervals in mask, return array of tuple (start, end) of each range
+#   start, end: start and end time of each interval
+def spans(mask, start, end):
+    edges = np.diff(np.concatenate(([0], mask.astype(np.int8), [0])))
+    first = np.flatnonzero(edges == 1)
+    last  = np.flatnonzero(edges == -1) - 1
+    return np.column_stack((np.asarray(start)[first], np.asarray(end)[last])) if len(first) else np.empty((0, 2))
@@ -17,62 +17,29 @@
 # SDS-View
 
 import argparse
-import struct
 import sys
+from os import path
 
 import matplotlib.pyplot as plt
 import numpy as np
 import yaml
 
+sys.path.append(path.join(path.dirname(path.abspath(__file__)), "..", "SDS-Lib"))
+import sds_container
+import sds_convert
+import sds_data
+import sds_live
+import sds_lod
+import sds_resample
+import sds_timing
 
-class RecordManager:
-    def __init__(self):
-        self.HEADER_SIZE    = 8
-        self.TIMESTAMP_SIZE = 4
-        self.data = bytearray()
-
-    # Flush data buffer
-    def flush(self):
-        self.data = bytearray()
-
-    # Private function for retrieving data from record
-    def __getRecord(self, file):
-        record = bytearray(file.read(self.HEADER_SIZE))
-        if len(record) == self.HEADER_SIZE:
-            timestamp = struct.unpack("I", record[:self.TIMESTAMP_SIZE])[0]
-            data_size = struct.unpack("I", record[self.TIMESTAMP_SIZE:])[0]
-            self.data.extend(bytearray(file.read(data_size)))
-            return True
-        else:
-            return False
-
-    # Extract all data from recording file
-    def getData(self, file):
-        record = True
-        while record:
-            record = self.__getRecord(file)
-        return self.data
-
-
-# Convert C style data type to Python style
-def getDataType(data_type):
-    if   data_type == "int16_t":
-        d_type = "h"
-    elif data_type == "uint16_t":
-        d_type = "H"
-    elif data_type == "int32_t":
-        d_type = "i"
-    elif data_type == "uint32_t":
-        d_type = "I"
-    elif data_type == "float":
-        d_type = "f"
-    elif data_type == "double":
-        d_type = "d"
-    else:
-        print(f"Unknown data type: {data_type}\n")
-        d_type = "I"
-
-    return d_type
+
+# Extract all data from recording file
+def getData(file):
+    records = sds_data.RecordFile(file)
+    if records.summary != "":
+        print(f"{file.name}: {records.summary}")
+    return records
 
 # Open SDS data file in read mode
 def openFile(file_name):
@@ -94,14 +61,87 @@ def closeFile(file_name):
         print(f"Error in closeFile({file_name}): {e}")
         sys.exit(1)
 
+# Sample times and values of a recording: timestamps interpolated between record timestamps as by SDS-Convert,
+# return tuple (sample times in seconds, list of channel arrays with unscaled values)
+def sampleData(records, data_desc, tick_frequency):
+    content = [{"type": desc["type"]} for desc in data_desc]
+    batch   = (records.timestamp / tick_frequency, records.data_size, records.data())
+    t, values = [], [[] for _ in content]
+    for block_t, block_values in sds_convert.blocks([batch], content):
+        t.append(block_t)
+        for channel_values, block in zip(values, block_values):
+            channel_values.append(block)
+    if len(t) == 0:
+        return np.empty(0), [np.empty(0, dtype=sds_data.sampleDtype(content)[n]) for n in range(len(content))]
+    return np.concatenate(t), [np.concatenate(v) for v in values]
+
+# Line of one channel plotted from its level-of-detail pyramid: about one point per pixel is drawn for the
+# visible time range, refined when the view is zoomed or panned
+class LodLine:
+    def __init__(self, ax, t, values, pyramid, scale, offset, label):
+        self.ax      = ax
+        self.t       = t
+        self.values  = values
+        self.pyramid = pyramid
+        self.scale   = scale
+        self.offset  = offset
+        self.line,   = ax.plot([], [], label=label)
+        self.update(0, len(values))
+
+    # Update line data for samples [first, last) (default: visible time range)
+    def update(self, first=None, last=None):
+        if first is None:
+            x0, x1 = self.ax.get_xlim()
+            first  = int(np.searchsorted(self.t, x0, side="left")) - 1
+            last   = int(np.searchsorted(self.t, x1, side="right")) + 1
+        points = max(int(self.ax.bbox.width), 1)
+        x, y = self.pyramid.select(self.values, first, last, points)
+
+        # Time of sample positions (bucket centers are between samples)
+        index = np.floor(x).astype(np.int64)
+        upper = np.minimum(index + 1, len(self.t) - 1)
+        t = self.t[index] + ((x - index) * (self.t[upper] - self.t[index])) if len(x) else x
+        self.line.set_data(t, (y.astype(np.float64) * self.scale) + self.offset)
+
+# Highlight gaps and bursts between records (see sds_timing), print summary
+#   timestamp: record timestamps in seconds
+def plotTiming(ax, title, timestamp, samples, freq, tick_frequency):
+    rate = sds_timing.sampleRate(timestamp, samples)
+    gap, burst = sds_timing.irregular(timestamp, samples, 1 / tick_frequency, rate)
+    if rate is not None:
+        # Gap: time after the samples of the record, burst: whole interval
+        expected = samples[:-1] / rate
+        gaps   = sds_timing.spans(gap, timestamp[:-1] + expected, timestamp[1:])
+        bursts = sds_timing.spans(burst, timestamp[:-1], timestamp[1:])
+        # Edge line keeps short ranges visible at any zoom
+        for ranges, color, label in ((gaps, "red", "gap"), (bursts, "orange", "burst")):
+            if len(ranges):
+                ax.broken_barh(list(zip(ranges[:, 0], ranges[:, 1] - ranges[:, 0])), (0, 1),
+                               transform=ax.get_xaxis_transform(), facecolor=color, edgecolor=color, linewidth=1,
+                               alpha=0.2, label=label)
+        print(f"{title}: {len(samples)} records, measured rate {rate:.6g} Hz (frequency: {freq:g} Hz), "
+              f"{int(gap.sum())} gap(s), {int(burst.sum())} burst(s)")
+
 # Create new figure and plot content
-def plotData(all_data, data_desc, freq, title, view3D):
+#   file_name: recording file (pyramids cached next to it, None: not cached)
+#   stream:    stream name of container file
+#   tick_frequency: tick frequency of record timestamps
+def plotData(records, data_desc, freq, title, view3D, file_name=None, stream=None, tick_frequency=1000):
     dim = {}
+    if any("type" not in desc for desc in data_desc):
+        sys.exit(1)
+    # Decode data points of all channels with sample times from record timestamps (starting with 0)
+    t, channels = sampleData(records, data_desc, tick_frequency)
+    start = records.timestamp[0] / tick_frequency if len(records) else 0
+    t -= start
+    pyramids = sds_lod.pyramids(channels, data_desc, file_name, stream)
     desc_n = 0
     desc_n_max = len(data_desc)
 
     # Create a new figure for each .sds file
     fig = plt.figure()
+    ax = fig.add_subplot()
+    lines = []
     for desc in data_desc:
         # Extract parameters from description in YAML file
         if "unit" in desc:
@@ -119,36 +159,32 @@ def plotData(all_data, data_desc, freq, title, view3D):
         else:
             offset = 0
 
-        if "type" in desc:
-            d_type = getDataType(desc["type"])
-        else:
-            sys.exit(1)
-
-        # Calculate number of bytes needed for decoding the data in .sds file
-        d_byte = struct.calcsize(d_type)
-        # Disunite raw data into a list of data points according to the number of bytes needed for each data point
-        tmp_data = [all_data[i:(i + d_byte)] for i in range(0, len(all_data), d_byte)]
-        # Keep only every n-th data point
-        tmp_data = tmp_data[desc_n::desc_n_max]
-        # Decode retrieved data points
-        data = struct.unpack(f"{int(len(tmp_data))}{d_type}", b''.join(tmp_data))
-        # Scale and offset data points
-        scaled_data = [((x * scale) + offset) for x in data]
-
-        # Generate timestamps using number of data points and sampling frequency
-        t = np.arange(0, len(data) / freq, 1 / freq)
-        if len(t) > len(data):
-            # Truncate timestamps to match the number of data points
-            t = t[0:len(data)]
-        plt.plot(t, scaled_data, label=desc["value"])
+        # Plot decimated data points
+        data = channels[desc_n]
+        lines.append(LodLine(ax, t, data, pyramids[desc_n], scale, offset, desc["value"]))
 
         # Store data points in a dictionary for later use when there are 3 axes described
         if view3D and (desc_n_max == 3):
-            dim[desc_n] = scaled_data
+            dim[desc_n] = (data.astype(np.float64) * scale) + offset
 
         # Increment description number
         desc_n += 1
 
+    ax.relim()
+    ax.autoscale_view()
+
+    # Highlight gaps and bursts between records
+    samples = records.data_size // sds_data.sampleDtype(data_desc).itemsize
+    plotTiming(ax, title, (records.timestamp / tick_frequency) - start, samples, freq, tick_frequency)
+
+    # Refine lines when the visible time range or the figure size changes
+    def refine(*_):
+        for line in lines:
+            line.update()
+        fig.canvas.draw_idle()
+    ax.callbacks.connect("xlim_changed", refine)
+    fig.canvas.mpl_connect("resize_event", refine)
+
     plt.title(title)
     plt.xlabel("seconds")
     plt.ylabel(unit)
@@ -164,6 +200,157 @@ def plotData(all_data, data_desc, freq, title, view3D):
         ax3d.set_ylabel(f"{data_desc[1]['value']} [{data_desc[1]['unit']}]")
         ax3d.set_zlabel(f"{data_desc[2]['value']} [{data_desc[2]['unit']}]")
 
+# Plot data of one stream described by metadata
+#   file_name, stream: see plotData()
+def plotStream(records, meta_data, view3D, file_name=None, stream=None):
+    data_name = meta_data["name"]
+    data_desc = meta_data["content"]
+    data_freq = meta_data["frequency"]
+    if not data_freq > 0:
+        print(f"Error: Sample frequency must be greater than 0 (f = {data_freq})\n")
+        sys.exit(0)
+    plotData(records, data_desc, data_freq, data_name, view3D, file_name, stream, meta_data.get("tick-frequency", 1000))
+
+# Plot channels of all streams resampled to a uniform time grid in one figure
+#   streams: list of tuple (records, metadata)
+def plotResampled(streams, rate, method):
+    resamplers = []
+    for records, meta_data in streams:
+        # Record timestamps in seconds
+        tick_frequency = meta_data.get("tick-frequency", 1000)
+        batch = (records.timestamp / tick_frequency, records.data_size, records.data())
+        blocks = sds_convert.blocks([batch], meta_data["content"])
+        resamplers.append(sds_resample.StreamResampler(blocks, len(meta_data["content"]), meta_data["frequency"],
+                                                       rate, method))
+
+    t = []
+    values = [[[] for _ in meta_data["content"]] for _, meta_data in streams]
+    for grid_t, grid_values in sds_resample.align(resamplers, rate):
+        t.append(grid_t)
+        for stream_values, channels in zip(values, grid_values):
+            for channel_values, channel in zip(stream_values, channels):
+                channel_values.append(channel)
+    if len(t) == 0:
+        return
+    t = np.concatenate(t)
+
+    plt.figure()
+    for (_, meta_data), stream_values in zip(streams, values):
+        for desc, channel_values in zip(meta_data["content"], stream_values):
+            plt.plot(t - t[0], np.concatenate(channel_values), label=f"{meta_data['name']}.{desc['value']}")
+    plt.title(f"Resampled to {rate:g} Hz")
+    plt.xlabel("seconds")
+    plt.legend()
+
+# Live view: scrolling plot of streams received from SDSIO-Server (option --live), one subplot per stream.
+# Samples of the last window seconds are kept in ring buffers; the plot is redrawn at most refresh times per second.
+class LiveView:
+    def __init__(self, subscriber, meta_data, stream_names, window, refresh):
+        self.subscriber   = subscriber
+        self.meta_data    = meta_data
+        self.stream_names = stream_names
+        self.window       = window
+        self.streams      = {}          # Stream id: LiveStream
+        self.lines        = {}          # Stream id: (axes, list of lines)
+        self.changed      = False
+        self.fig          = plt.figure(layout="constrained")
+        self.timer        = self.fig.canvas.new_timer(interval=int(1000 / refresh))
+        self.timer.add_callback(self.update)
+
+    # Metadata of stream opened by server (YAML file with the same name overrides metadata of the server)
+    def __metadata(self, name, metadata):
+        if (self.meta_data is not None) and (self.meta_data["name"] == name):
+            return self.meta_data
+        if metadata != "":
+            return yaml.load(metadata, Loader=yaml.FullLoader)["sds"]
+        return None
+
+    # Create one subplot for each stream
+    def __layout(self):
+        self.fig.clear()
+        self.lines = {}
+        for n, (stream_id, stream) in enumerate(self.streams.items()):
+            ax = self.fig.add_subplot(len(self.streams), 1, n + 1)
+            lines = [ax.plot([], [], label=desc["value"])[0] for desc in stream.content]
+            ax.set_title(f"{stream.name} (closed)" if stream.closed else stream.name)
+            ax.set_ylabel(stream.content[0].get("unit", "raw") if stream.content else "")
+            ax.grid(linestyle=":")
+            ax.legend(loc="upper left")
+            self.lines[stream_id] = (ax, lines)
+        if self.lines:
+            ax.set_xlabel("seconds")
+        self.changed = True
+
+    # Handle messages received from server
+    def __receive(self):
+        messages = self.subscriber.read()
+        if messages is None:
+            print("Live stream closed by server\n")
+            self.timer.stop()
+            return
+        layout = False
+        for command, stream_id, argument, data in messages:
+            if command == sds_live.OPEN:
+                name, _, metadata = data.decode("utf-8").partition("\0")
+                if (self.stream_names is not None) and (name not in self.stream_names):
+                    continue
+                stream_meta = self.__metadata(name, metadata)
+                if (stream_meta is None) or not (stream_meta.get("frequency", 0) > 0):
+                    print(f"Live stream {name}: no metadata, not plotted\n")
+                    continue
+                # A stream opened again replaces the closed stream with the same name
+                for old_id in [i for i, s in self.streams.items() if s.closed and (s.name == name)]:
+                    self.streams.pop(old_id)
+                self.streams[stream_id] = sds_live.LiveStream(name, stream_meta, self.window)
+                layout = True
+            elif command == sds_live.WRITE:
+                stream = self.streams.get(stream_id)
+                if stream is not None:
+                    stream.add(data, bool(argument & 1))
+                    self.changed = True
+            elif command == sds_live.CLOSE:
+                stream = self.streams.get(stream_id)
+                if stream is not None:
+                    stream.closed = True
+                    layout = True
+        if layout:
+            self.__layout()
+
+    # Update plot with samples of the last window seconds (decimated to about one point per pixel)
+    def update(self):
+        self.__receive()
+        if not self.changed:
+            return
+        self.changed = False
+        for stream_id, (ax, lines) in self.lines.items():
+            stream = self.streams[stream_id]
+            first, values = stream.samples()
+            points = max(int(ax.bbox.width), 1)
+            for line, v in zip(lines, values):
+                if len(v) > (2 * points):
+                    bucket = int(np.ceil(len(v) / points))
+                    lo, hi = sds_lod.decimate(v, v, bucket)
+                    start  = np.arange(len(lo)) * bucket
+                    x = np.repeat((start + np.minimum(start + bucket, len(v)) - 1) / 2, 2)
+                    y = np.empty(2 * len(lo))
+                    y[0::2] = lo
+                    y[1::2] = hi
+                else:
+                    x = np.arange(len(v), dtype=np.float64)
+                    y = v
+                line.set_data((x + first) / stream.frequency, y)
+            end = stream.count / stream.frequency
+            ax.set_xlim(max(end, self.window) - self.window, max(end, self.window))
+            ax.relim()
+            ax.autoscale_view(scalex=False)
+        self.fig.canvas.draw_idle()
+
+    def run(self):
+        self.timer.start()
+        plt.show()
+        self.subscriber.close()
+
+
 # Main function
 def main():
     formatter = lambda prog: argparse.HelpFormatter(prog,max_help_position=60)
@@ -171,42 +358,106 @@ def main():
                                      formatter_class=formatter)
 
     required = parser.add_argument_group("required")
-    required.add_argument("-y", dest="yaml", metavar="<yaml_file>",
-                            help="YAML sensor description file", required=True)
     required.add_argument("-s", dest="sds", metavar="<sds_file>",
-                            help="SDS data recording file", nargs="+", required=True)
+                            help="SDS data recording file or container file (not used with --live)", nargs="+", default=None)
 
     optional = parser.add_argument_group("optional")
+    optional.add_argument("-y", dest="yaml", metavar="<yaml_file>",
+                            help="YAML sensor description file (required for SDS data recording files)", default=None)
+    optional.add_argument("--stream", dest="stream", metavar="<name>",
+                            help="Streams viewed from container file or live view (default: all)", nargs="+", default=None)
     optional.add_argument("--3D", dest="view3D",
                             help="Plot 3D view in addition to normal 2D", action="store_true")
+    optional.add_argument("--no-cache", dest="no_cache",
+                            help="Do not read or write level-of-detail cache files next to the recordings",
+                            action="store_true")
+    optional.add_argument("--live", dest="live", metavar="<port>",
+                            help=f"Live view of streams written to SDSIO-Server started with --live on local TCP port "
+                                 f"(default: {sds_live.DEFAULT_PORT})",
+                            type=int, nargs="?", const=sds_live.DEFAULT_PORT, default=None)
+    optional.add_argument("--window", dest="window", metavar="<seconds>",
+                            help="Time window of live view in seconds (default: 10)", type=float, default=10)
+    optional.add_argument("--refresh", dest="refresh", metavar="<rate>",
+                            help="Maximum redraw rate of live view in Hz (default: 30)", type=float, default=30)
+    optional.add_argument("--resample", dest="resample", metavar="<rate>",
+                            help="Plot all streams resampled to a uniform time grid with rate in Hz in one figure",
+                            type=float, default=None)
+    optional.add_argument("--resample-method", dest="resample_method", choices=sds_resample.METHODS,
+                            help="Resampling method: polyphase FIR or sample-and-hold (default: FIR for streams with "
+                                 "frequency at or above rate, otherwise sample-and-hold)", default=None)
 
     args = parser.parse_args()
 
     # Load data from .yml file
-    meta_file = openFile(args.yaml)
-    meta_data = yaml.load(meta_file, Loader=yaml.FullLoader)["sds"]
-    closeFile(meta_file)
+    meta_data = None
+    if args.yaml is not None:
+        meta_file = openFile(args.yaml)
+        meta_data = yaml.load(meta_file, Loader=yaml.FullLoader)["sds"]
+        closeFile(meta_file)
+
+    if args.live is not None:
+        if not ((args.window > 0) and (args.refresh > 0)):
+            print("Error: Live view window and refresh rate must be greater than 0\n")
+            sys.exit(1)
+        try:
+            subscriber = sds_live.Subscriber(args.live)
+        except OSError as e:
+            print(f"Error: Could not connect to SDSIO-Server live port {args.live}: {e}\n")
+            sys.exit(1)
+        LiveView(subscriber, meta_data, args.stream, args.window, args.refresh).run()
+        return
 
-    # Parse description file
-    data_name = meta_data["name"]
-    data_desc = meta_data["content"]
-    data_freq = meta_data["frequency"]
-    if not data_freq > 0:
-        print(f"Error: Sample frequency must be greater than 0 (f = {data_freq})\n")
-        sys.exit(0)
+    if args.sds is None:
+        print("Error: the following arguments are required: -s\n")
+        sys.exit(1)
+
+    if (args.resample is not None) and not (args.resample > 0):
+        print(f"Error: Resample rate must be greater than 0 (rate = {args.resample})\n")
+        sys.exit(1)
 
-    # Record manager
-    Record = RecordManager()
+    # Recording file of level-of-detail cache files (None: not cached)
+    cache = lambda file_name: None if args.no_cache else file_name
 
-    # Read .sds file/files
+    # Read .sds file/files or streams of container file/files
+    # (kept for one figure when resampling)
+    resampled = []
     for arg in args.sds:
         file = openFile(arg)
-        data = Record.getData(file)
+        if sds_container.isContainer(file):
+            container = sds_container.ContainerReader(file)
+            for stream in container.streams:
+                if (args.stream is not None) and (stream.name not in args.stream):
+                    continue
+                if (meta_data is not None) and (meta_data["name"] == stream.name):
+                    stream_meta = meta_data
+                elif stream.metadata != "":
+                    stream_meta = yaml.load(stream.metadata, Loader=yaml.FullLoader)["sds"]
+                else:
+                    print(f"Error: No metadata for stream {stream.name} in {arg}\n")
+                    sys.exit(1)
+                records = getData(container.open(stream))
+                if args.resample is not None:
+                    resampled.append((records, stream_meta))
+                    continue
+                plotStream(records, stream_meta, args.view3D, cache(arg), stream.name)
+                records.close()
+        else:
+            if meta_data is None:
+                print(f"Error: YAML sensor description file is required for {arg}\n")
+                sys.exit(1)
+            records = getData(file)
+            if args.resample is not None:
+                resampled.append((records, meta_data))
+            else:
+                # Plot data from .sds file/files
+                plotStream(records, meta_data, args.view3D, cache(arg))
+                records.close()
         closeFile(file)
-        Record.flush()
 
-        # Plot data from .sds file/files
-        plotData(data, data_desc, data_freq, data_name, args.view3D)
+    if args.resample is not None:
+        plotResampled(resampled, args.resample, args.resample_method)
+        for records, _ in resampled:
+            records.close()
 
     # Show plotted figures
     plt.grid(linestyle=":")
@@ -0,0 +1,876 @@
+/*
+ * Copyright (c) 2023 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// SDS I/O Server - native socket server (Linux, epoll)
+//
+// Implements the socket interface of sdsio-server.py (streams written to <name>.<index>.sds files, sessions with
+// resume and acknowledged writes) for high data rates and many concurrent connections in one thread:
+//  - connections are served by epoll (the server sleeps while no data is received)
+//  - requests are parsed incrementally per connection: write data is copied from the receive buffer
+//    directly into the file buffer of the stream (requests are never assembled in memory)
+//  - files are written from large aligned buffers, optionally with O_DIRECT (option --direct)
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+// Configuration
+#define DEFAULT_PORT            5050U
+#define DEFAULT_SESSION_TIMEOUT 300.0   // in seconds
+#define RECV_BUF_SIZE           (256U * 1024U)
+#define FILE_BUF_SIZE           (4U * 1024U * 1024U)
+#define FILE_ALIGN              4096U   // Alignment of file buffers and O_DIRECT writes
+#define MAX_NAME_SIZE           256U
+#define MAX_EVENTS              64
+#define EXPIRE_INTERVAL         1000    // Period of session timeout check in ms
+
+// SDS I/O header
+typedef struct {
+  uint32_t command;
+  uint32_t sdsio_id;
+  uint32_t argument;
+  uint32_t data_size;
+} header_t;
+
+// Commands
+#define SDSIO_CMD_OPEN          1U
+#define SDSIO_CMD_CLOSE         2U
+#define SDSIO_CMD_WRITE         3U
+#define SDSIO_CMD_READ          4U
+#define SDSIO_CMD_SESSION       5U
+#define SDSIO_CMD_RESUME        6U
+#define SDSIO_CMD_ACK           7U
+
+// Open request argument
+#define SDSIO_MODE_WRITE        1U
+
+// Write request argument
+#define SDSIO_WRITE_ACK         1U      // Acknowledge requested
+
+struct conn_s;
+struct stream_s;
+
+// Stream scope: streams of a session or of a connection without session.
+// Stream identifiers are numbered per scope, so streams of different devices do not collide and a request can
+// only use streams of its own session or connection.
+typedef struct {
+  uint32_t          stream_id;          // Last stream identifier
+  uint32_t          session_id;         // Session of scope (0: connection without session)
+  struct stream_s  *streams;            // Streams of scope
+  char             *dir;                // Output subdirectory (created with first stream, NULL: none)
+  char              address[64];        // Address of device (output subdirectory)
+} scope_t;
+
+// Stream (file written by write requests)
+typedef struct stream_s {
+  uint32_t          id;
+  int               fd;                 // File (buffered I/O)
+  int               fd_direct;          // Same file opened with O_DIRECT (-1: not used)
+  uint8_t          *buf;                // File buffer (FILE_ALIGN aligned)
+  uint32_t          fill;               // Number of bytes in file buffer
+  uint64_t          base;               // File offset of file buffer
+  uint64_t          size;               // Number of bytes of complete write requests
+  uint64_t          persisted;          // Number of bytes of complete write requests written to file
+  uint32_t          pending;            // Number of bytes of write request in progress (not yet complete)
+  int               error;              // File write failed (further data is discarded)
+  struct conn_s    *conn;               // Connection of stream (NULL: detached session stream)
+  struct conn_s    *writer;             // Connection with write request in progress (NULL: none)
+  scope_t          *scope;              // Scope of stream
+  struct stream_s  *next;               // Next stream of scope
+  char              fname[];
+} stream_t;
+
+// Session (streams resumed by a reconnecting client)
+typedef struct session_s {
+  uint32_t          id;
+  scope_t           scope;              // Streams of session
+  uint32_t          conn_cnt;           // Number of connections of session
+  double            detached;           // Time when last connection was closed (0: attached)
+  struct session_s *next;
+} session_t;
+
+// Connection with request parser state
+typedef struct conn_s {
+  int               fd;
+  scope_t           local;              // Streams opened without session
+  session_t        *session;            // Session of connection (NULL: no session)
+  header_t          header;             // Header of current request
+  uint32_t          header_cnt;         // Number of header bytes received
+  uint32_t          data_cnt;           // Number of data bytes of current request received
+  stream_t         *stream;             // Stream of current write request (NULL: data is discarded)
+  char              name[MAX_NAME_SIZE];// Data of current open request (stream name)
+  uint8_t          *out;                // Responses not yet sent
+  uint32_t          out_len;
+  uint32_t          out_size;
+  char              addr[64];
+  struct conn_s    *next;
+} conn_t;
+
+static const char    *OutDir         = ".";
+static double         SessionTimeout = DEFAULT_SESSION_TIMEOUT;
+static int            Direct         = 0;
+static int            Subdirs        = 0;
+static int            EpollFd        = -1;
+static uint32_t       SessionId      = 0U;
+static session_t     *Sessions       = NULL;
+static conn_t        *Conns          = NULL;
+static volatile sig_atomic_t Exit    = 0;
+static uint8_t        RecvBuf[RECV_BUF_SIZE];
+
+// Monotonic time in seconds
+static double Now (void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9));
+}
+
+// Write all data at file offset, return 0 on success
+static int WriteAll (int fd, const uint8_t *buf, size_t size, uint64_t offset) {
+  ssize_t n;
+
+  while (size != 0U) {
+    n = pwrite(fd, buf, size, (off_t)offset);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    buf    += n;
+    size   -= (size_t)n;
+    offset += (uint64_t)n;
+  }
+  return 0;
+}
+
+// Scope of stream identifiers used on connection
+static scope_t *ConnScope (conn_t *conn) {
+  return (conn->session != NULL) ? &conn->session->scope : &conn->local;
+}
+
+// Output directory of scope: output directory, or with subdirectories <outdir>/<device address> for connections
+// without session and <outdir>/<device address>/Session.<index> for sessions (NULL on error)
+static const char *ScopeDir (scope_t *scope) {
+  size_t   size;
+  uint32_t index;
+  char    *dir;
+
+  if ((Subdirs == 0) || (scope->dir != NULL)) {
+    return (scope->dir != NULL) ? scope->dir : OutDir;
+  }
+  size = strlen(OutDir) + strlen(scope->address) + 32U;
+  dir  = malloc(size);
+  if (dir == NULL) {
+    return NULL;
+  }
+  snprintf(dir, size, "%s/%s", OutDir, scope->address);
+  if ((mkdir(dir, 0777) != 0) && (errno != EEXIST)) {
+    printf("Could not create directory %s. Error: %s\n\n", dir, strerror(errno));
+    free(dir);
+    return NULL;
+  }
+  if (scope->session_id != 0U) {
+    for (index = 0U; ; index++) {
+      snprintf(dir, size, "%s/%s/Session.%u", OutDir, scope->address, index);
+      if (mkdir(dir, 0777) == 0) {
+        break;
+      }
+      if (errno != EEXIST) {
+        printf("Could not create directory %s. Error: %s\n\n", dir, strerror(errno));
+        free(dir);
+        return NULL;
+      }
+    }
+  }
+  scope->dir = dir;
+  return dir;
+}
+
+// Find stream of scope by identifier
+static stream_t *StreamFind (const scope_t *scope, uint32_t id) {
+  stream_t *stream;
+
+  for (stream = scope->streams; stream != NULL; stream = stream->next) {
+    if (stream->id == id) {
+      return stream;
+    }
+  }
+  return NULL;
+}
+
+// Write file buffer to file.
+// O_DIRECT writes whole FILE_ALIGN blocks, the remaining bytes stay in the buffer and are written again with the
+// next block. When the file must be complete (partial flush) they are also written with buffered I/O.
+static void StreamFlush (stream_t *stream, int partial) {
+  uint32_t size = stream->fill;
+  int      err  = 0;
+
+  if (stream->fd_direct >= 0) {
+    size &= ~(FILE_ALIGN - 1U);
+    if (size != 0U) {
+      err = WriteAll(stream->fd_direct, stream->buf, size, stream->base);
+      if (err != 0) {
+        // O_DIRECT not supported for this write, continue with buffered I/O
+        close(stream->fd_direct);
+        stream->fd_direct = -1;
+        size = stream->fill;
+        err  = WriteAll(stream->fd, stream->buf, size, stream->base);
+      }
+    }
+  } else if (size != 0U) {
+    err = WriteAll(stream->fd, stream->buf, size, stream->base);
+  }
+  if ((err == 0) && (partial != 0) && (stream->fill != size)) {
+    err = WriteAll(stream->fd, &stream->buf[size], stream->fill - size, stream->base + size);
+  }
+  if (err != 0) {
+    printf("Could not write to file %s. Error: %s\n\n", stream->fname, strerror(errno));
+    stream->error = 1;
+  }
+
+  stream->base += size;
+  stream->fill -= size;
+  if (stream->fill != 0U) {
+    memmove(stream->buf, &stream->buf[size], stream->fill);
+  }
+}
+
+// Append data of write request in progress to stream (counted when the request is complete)
+static void StreamWrite (stream_t *stream, const uint8_t *data, uint32_t size) {
+  uint32_t n;
+
+  if (stream->error != 0) {
+    return;
+  }
+  stream->pending += size;
+  while (size != 0U) {
+    if ((stream->fill == 0U) && (stream->fd_direct < 0) && (size >= FILE_BUF_SIZE)) {
+      // Large data without O_DIRECT: write without copying
+      if (WriteAll(stream->fd, data, size, stream->base) != 0) {
+        printf("Could not write to file %s. Error: %s\n\n", stream->fname, strerror(errno));
+        stream->error = 1;
+      }
+      stream->base += size;
+      return;
+    }
+    n = FILE_BUF_SIZE - stream->fill;
+    if (n > size) {
+      n = size;
+    }
+    memcpy(&stream->buf[stream->fill], data, n);
+    stream->fill += n;
+    data += n;
+    size -= n;
+    if (stream->fill == FILE_BUF_SIZE) {
+      StreamFlush(stream, 0);
+    }
+  }
+}
+
+// Write request complete: count its data in stream size
+static void StreamCommit (stream_t *stream) {
+  if (stream->error == 0) {
+    stream->size += stream->pending;
+  }
+  stream->pending = 0U;
+  stream->writer  = NULL;
+}
+
+// Discard data of write request in progress (request not completed by its connection).
+// Data already written to the file is truncated, so the file ends with the last complete request.
+static void StreamDiscard (stream_t *stream) {
+  uint64_t end;
+  uint32_t n;
+
+  if (stream->writer != NULL) {
+    stream->writer->stream = NULL;
+    stream->writer         = NULL;
+  }
+  if ((stream->pending == 0U) || (stream->error != 0)) {
+    stream->pending = 0U;
+    return;
+  }
+  if (stream->pending <= stream->fill) {
+    stream->fill -= stream->pending;
+  } else {
+    end = stream->base + stream->fill - stream->pending;
+    if (ftruncate(stream->fd, (off_t)end) != 0) {
+      printf("Could not write to file %s. Error: %s\n\n", stream->fname, strerror(errno));
+      stream->error = 1;
+    }
+    // File buffer continues at the last aligned file offset (O_DIRECT writes whole blocks)
+    n = (stream->fd_direct >= 0) ? (uint32_t)(end & (FILE_ALIGN - 1U)) : 0U;
+    stream->base = end - n;
+    stream->fill = n;
+    if ((n != 0U) && (pread(stream->fd, stream->buf, n, (off_t)stream->base) != (ssize_t)n)) {
+      close(stream->fd_direct);
+      stream->fd_direct = -1;
+      stream->base      = end;
+      stream->fill      = 0U;
+    }
+  }
+  stream->pending = 0U;
+}
+
+// Flush stream and return number of bytes persisted (modulo 2^32).
+// After a write error the bytes persisted before the error are reported, the client counts the others as lost.
+static uint32_t StreamPersisted (stream_t *stream) {
+  StreamFlush(stream, 1);
+  if (stream->error == 0) {
+    stream->persisted = stream->size;
+  }
+  return (uint32_t)stream->persisted;
+}
+
+// Open stream file <name>.<index>.sds in output directory of connection scope, return NULL on error
+static stream_t *StreamOpen (const char *name, conn_t *conn) {
+  scope_t    *scope = ConnScope(conn);
+  const char *dir;
+  stream_t   *stream;
+  size_t      size;
+  uint32_t    index;
+
+  if ((name[0] == '\0') || (strchr(name, '/') != NULL)) {
+    printf("Could not open file for stream name \"%s\"\n\n", name);
+    return NULL;
+  }
+  dir = ScopeDir(scope);
+  if (dir == NULL) {
+    return NULL;
+  }
+  size   = strlen(dir) + strlen(name) + 32U;
+  stream = calloc(1U, sizeof(stream_t) + size);
+  if (stream == NULL) {
+    return NULL;
+  }
+  if (posix_memalign((void **)&stream->buf, FILE_ALIGN, FILE_BUF_SIZE) != 0) {
+    free(stream);
+    return NULL;
+  }
+
+  stream->fd = -1;
+  for (index = 0U; stream->fd < 0; index++) {
+    snprintf(stream->fname, size, "%s/%s.%u.sds", dir, name, index);
+    // Opened for reading as well: the file buffer is reloaded from the file when a partial request is discarded
+    stream->fd = open(stream->fname, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+    if ((stream->fd < 0) && (errno != EEXIST)) {
+      printf("Could not open file %s. Error: %s\n\n", stream->fname, strerror(errno));
+      free(stream->buf);
+      free(stream);
+      return NULL;
+    }
+  }
+  stream->fd_direct = (Direct != 0) ? open(stream->fname, O_WRONLY | O_DIRECT | O_CLOEXEC) : -1;
+
+  stream->id     = ++scope->stream_id;
+  stream->conn   = conn;
+  stream->scope  = scope;
+  stream->next   = scope->streams;
+  scope->streams = stream;
+  return stream;
+}
+
+// Close stream (buffered data is written)
+static void StreamClose (stream_t *stream) {
+  stream_t **link;
+
+  for (link = &stream->scope->streams; *link != NULL; link = &(*link)->next) {
+    if (*link == stream) {
+      *link = stream->next;
+      break;
+    }
+  }
+  StreamDiscard(stream);
+  StreamFlush(stream, 1);
+  if (stream->fd_direct >= 0) {
+    close(stream->fd_direct);
+  }
+  if (close(stream->fd) != 0) {
+    printf("Could not close file %s. Error: %s\n\n", stream->fname, strerror(errno));
+  }
+  free(stream->buf);
+  free(stream);
+}
+
+// Close all streams of scope
+static void ScopeClose (scope_t *scope) {
+  while (scope->streams != NULL) {
+    StreamClose(scope->streams);
+  }
+  free(scope->dir);
+  scope->dir = NULL;
+}
+
+// Send response (queued when the connection is not ready)
+static void ConnSend (conn_t *conn, uint32_t command, uint32_t sdsio_id, uint32_t argument) {
+  header_t           header = { command, sdsio_id, argument, 0U };
+  const uint8_t     *data   = (const uint8_t *)&header;
+  uint32_t           size   = sizeof(header);
+  struct epoll_event event;
+  ssize_t            n;
+  uint8_t           *out;
+
+  if (conn->out_len == 0U) {
+    n = send(conn->fd, data, size, MSG_NOSIGNAL);
+    if (n > 0) {
+      data += n;
+      size -= (uint32_t)n;
+    }
+    if (size == 0U) {
+      return;
+    }
+  }
+  if ((conn->out_len + size) > conn->out_size) {
+    out = realloc(conn->out, conn->out_size + 4096U);
+    if (out == NULL) {
+      return;
+    }
+    conn->out       = out;
+    conn->out_size += 4096U;
+  }
+  memcpy(&conn->out[conn->out_len], data, size);
+  conn->out_len += size;
+
+  event.events   = EPOLLIN | EPOLLOUT;
+  event.data.ptr = conn;
+  epoll_ctl(EpollFd, EPOLL_CTL_MOD, conn->fd, &event);
+}
+
+// Send queued responses (connection is ready)
+static void ConnFlush (conn_t *conn) {
+  struct epoll_event event;
+  ssize_t            n;
+
+  n = send(conn->fd, conn->out, conn->out_len, MSG_NOSIGNAL);
+  if (n > 0) {
+    conn->out_len -= (uint32_t)n;
+    memmove(conn->out, &conn->out[n], conn->out_len);
+  }
+  if (conn->out_len == 0U) {
+    event.events   = EPOLLIN;
+    event.data.ptr = conn;
+    epoll_ctl(EpollFd, EPOLL_CTL_MOD, conn->fd, &event);
+  }
+}
+
+// Execute request (data of write requests is already written to the stream)
+static void ConnExecute (conn_t *conn) {
+  const header_t *header = &conn->header;
+  stream_t       *stream;
+  session_t      *session;
+  uint32_t        id;
+
+  switch (header->command) {
+    case SDSIO_CMD_OPEN:
+      stream = NULL;
+      if (header->argument == SDSIO_MODE_WRITE) {
+        stream = StreamOpen(conn->name, conn);
+      }
+      // Read mode not supported
+      ConnSend(conn, SDSIO_CMD_OPEN, (stream != NULL) ? stream->id : 0U, header->argument);
+      break;
+
+    case SDSIO_CMD_CLOSE:
+      stream = StreamFind(ConnScope(conn), header->sdsio_id);
+      if (stream != NULL) {
+        StreamClose(stream);
+      }
+      break;
+
+    case SDSIO_CMD_WRITE:
+      // Acknowledge with number of bytes persisted when requested
+      if ((header->argument & SDSIO_WRITE_ACK) != 0U) {
+        stream = StreamFind(ConnScope(conn), header->sdsio_id);
+        ConnSend(conn, SDSIO_CMD_ACK, header->sdsio_id, (stream != NULL) ? StreamPersisted(stream) : 0U);
+      }
+      break;
+
+    case SDSIO_CMD_SESSION:
+      // Continue existing session or start a new one
+      for (session = Sessions; session != NULL; session = session->next) {
+        if ((header->argument != 0U) && (session->id == header->argument)) {
+          break;
+        }
+      }
+      if (session != NULL) {
+        printf("  Session %u resumed\n\n", session->id);
+      } else {
+        session = calloc(1U, sizeof(session_t));
+        if (session == NULL) {
+          break;
+        }
+        session->id               = ++SessionId;
+        session->scope.session_id = session->id;
+        memcpy(session->scope.address, conn->local.address, sizeof(session->scope.address));
+        session->next             = Sessions;
+        Sessions                  = session;
+      }
+      if (conn->session != session) {
+        if (conn->session != NULL) {
+          conn->session->conn_cnt--;
+        }
+        conn->session = session;
+        session->conn_cnt++;
+      }
+      session->detached = 0.0;
+      ConnSend(conn, SDSIO_CMD_SESSION, 0U, session->id);
+      break;
+
+    case SDSIO_CMD_RESUME:
+      // Stream continues on connection, respond with number of bytes persisted
+      stream = (conn->session != NULL) ? StreamFind(&conn->session->scope, header->sdsio_id) : NULL;
+      id     = header->sdsio_id;
+      if (stream != NULL) {
+        // Write request in progress on the previous connection is not completed
+        StreamDiscard(stream);
+        stream->conn = conn;
+      } else {
+        printf("Could not resume stream %u\n\n", id);
+        stream = NULL;
+        id     = 0U;
+      }
+      ConnSend(conn, SDSIO_CMD_RESUME, id, (stream != NULL) ? StreamPersisted(stream) : 0U);
+      break;
+
+    default:
+      printf("Invalid command: %u\n", header->command);
+      break;
+  }
+}
+
+// Parse received data and execute complete requests
+static void ConnParse (conn_t *conn, const uint8_t *data, uint32_t size) {
+  uint32_t n;
+
+  while (size != 0U) {
+    if (conn->header_cnt < sizeof(header_t)) {
+      // Request header
+      n = sizeof(header_t) - conn->header_cnt;
+      if (n > size) {
+        n = size;
+      }
+      memcpy((uint8_t *)&conn->header + conn->header_cnt, data, n);
+      conn->header_cnt += n;
+      data += n;
+      size -= n;
+      if (conn->header_cnt < sizeof(header_t)) {
+        break;
+      }
+      // New request
+      conn->data_cnt = 0U;
+      conn->stream   = NULL;
+      if ((conn->header.command == SDSIO_CMD_WRITE) && (conn->header.data_size != 0U)) {
+        conn->stream = StreamFind(ConnScope(conn), conn->header.sdsio_id);
+        if ((conn->stream == NULL) || (conn->stream->writer != NULL)) {
+          printf("Could not write to stream %u\n\n", conn->header.sdsio_id);
+          conn->stream = NULL;
+        } else {
+          conn->stream->writer = conn;
+        }
+      }
+    } else {
+      // Request data
+      n = conn->header.data_size - conn->data_cnt;
+      if (n > size) {
+        n = size;
+      }
+      if (conn->stream != NULL) {
+        StreamWrite(conn->stream, data, n);
+      } else if ((conn->header.command == SDSIO_CMD_OPEN) && (conn->data_cnt < (MAX_NAME_SIZE - 1U))) {
+        memcpy(&conn->name[conn->data_cnt], data, ((MAX_NAME_SIZE - 1U - conn->data_cnt) < n) ?
+                                                   (MAX_NAME_SIZE - 1U - conn->data_cnt) : n);
+      }
+      conn->data_cnt += n;
+      data += n;
+      size -= n;
+    }
+
+    if (conn->data_cnt == conn->header.data_size) {
+      // Whole request received
+      if (conn->header.command == SDSIO_CMD_OPEN) {
+        conn->name[(conn->data_cnt < MAX_NAME_SIZE) ? conn->data_cnt : (MAX_NAME_SIZE - 1U)] = '\0';
+      }
+      if (conn->stream != NULL) {
+        StreamCommit(conn->stream);
+        conn->stream = NULL;
+      }
+      ConnExecute(conn);
+      conn->header_cnt = 0U;
+      conn->data_cnt   = 0U;
+    }
+  }
+}
+
+// Close connection: close its streams or keep them for session resume
+static void ConnClose (conn_t *conn) {
+  stream_t *stream;
+  conn_t  **link;
+
+  printf("  Client disconnected: %s\n\n", conn->addr);
+  epoll_ctl(EpollFd, EPOLL_CTL_DEL, conn->fd, NULL);
+  close(conn->fd);
+
+  // Write request cut off by the lost connection is not persisted (resumed client sends it again)
+  if (conn->stream != NULL) {
+    StreamDiscard(conn->stream);
+  }
+
+  ScopeClose(&conn->local);
+  if (conn->session != NULL) {
+    for (stream = conn->session->scope.streams; stream != NULL; stream = stream->next) {
+      if (stream->conn == conn) {
+        stream->conn = NULL;
+      }
+    }
+    conn->session->conn_cnt--;
+    if (conn->session->conn_cnt == 0U) {
+      conn->session->detached = Now();
+    }
+  }
+  for (link = &Conns; *link != NULL; link = &(*link)->next) {
+    if (*link == conn) {
+      *link = conn->next;
+      break;
+    }
+  }
+  free(conn->out);
+  free(conn);
+}
+
+// Accept connections
+static void ServerAccept (int listen_fd) {
+  struct sockaddr_in addr;
+  socklen_t          addr_len;
+  struct epoll_event event;
+  conn_t            *conn;
+  int                fd;
+  int                one = 1;
+
+  for (;;) {
+    addr_len = sizeof(addr);
+    fd = accept4(listen_fd, (struct sockaddr *)&addr, &addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR) && (errno != ECONNABORTED)) {
+        printf("Server accept error: %s\n\n", strerror(errno));
+      }
+      return;
+    }
+    // Responses are small and awaited by the client
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    conn = calloc(1U, sizeof(conn_t));
+    if (conn == NULL) {
+      close(fd);
+      continue;
+    }
+    conn->fd = fd;
+    snprintf(conn->addr, sizeof(conn->addr), "%s:%u", inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
+    snprintf(conn->local.address, sizeof(conn->local.address), "%s", inet_ntoa(addr.sin_addr));
+
+    event.events   = EPOLLIN;
+    event.data.ptr = conn;
+    if (epoll_ctl(EpollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+      close(fd);
+      free(conn);
+      continue;
+    }
+    conn->next = Conns;
+    Conns      = conn;
+    printf("  Client connected: %s\n\n", conn->addr);
+  }
+}
+
+// Close streams of sessions which were not resumed within session timeout
+static void SessionExpire (void) {
+  session_t **link = &Sessions;
+  session_t  *session;
+  double      now  = Now();
+
+  while ((session = *link) != NULL) {
+    if ((session->detached != 0.0) && ((now - session->detached) >= SessionTimeout)) {
+      printf("  Session %u expired\n\n", session->id);
+      ScopeClose(&session->scope);
+      *link = session->next;
+      free(session);
+    } else {
+      link = &session->next;
+    }
+  }
+}
+
+static void SignalHandler (int sig) {
+  (void)sig;
+  Exit = 1;
+}
+
+static void Usage (const char *prog) {
+  printf("usage: %s [-h] [--port <TCP Port>] [--outdir <Output dir>] [--session-timeout <Timeout>] [--subdirs]\n"
+         "       [--direct]\n\n"
+         "SDS I/O server (native socket server)\n\n"
+         "optional:\n"
+         "  -h, --help                   show this help message and exit\n"
+         "  --port <TCP Port>            TCP port (default: %u)\n"
+         "  --outdir <Output dir>        Output directory\n"
+         "  --session-timeout <Timeout>  Time in seconds to keep streams of a disconnected session open for resume\n"
+         "                               (default: %g)\n"
+         "  --subdirs                    Write recordings of each device and session to output subdirectory\n"
+         "                               <device address>/Session.<index>\n"
+         "  --direct                     Write files with O_DIRECT (bypass page cache)\n",
+         prog, DEFAULT_PORT, DEFAULT_SESSION_TIMEOUT);
+}
+
+int main (int argc, char *argv[]) {
+  static const struct option options[] = {
+    { "help",            no_argument,       NULL, 'h' },
+    { "port",            required_argument, NULL, 'p' },
+    { "outdir",          required_argument, NULL, 'o' },
+    { "session-timeout", required_argument, NULL, 't' },
+    { "subdirs",         no_argument,       NULL, 's' },
+    { "direct",          no_argument,       NULL, 'd' },
+    { NULL,              0,                 NULL, 0   }
+  };
+  struct epoll_event events[MAX_EVENTS];
+  struct epoll_event event;
+  struct sockaddr_in addr;
+  struct sigaction   action;
+  double             expire;
+  conn_t            *conn;
+  session_t         *session;
+  ssize_t            n;
+  uint32_t           port = DEFAULT_PORT;
+  int                listen_fd;
+  int                one  = 1;
+  int                count;
+  int                opt;
+  int                i;
+
+  while ((opt = getopt_long(argc, argv, "h", options, NULL)) != -1) {
+    switch (opt) {
+      case 'p':
+        port = (uint32_t)strtoul(optarg, NULL, 10);
+        break;
+      case 'o':
+        OutDir = optarg;
+        break;
+      case 't':
+        SessionTimeout = strtod(optarg, NULL);
+        break;
+      case 's':
+        Subdirs = 1;
+        break;
+      case 'd':
+        Direct = 1;
+        break;
+      case 'h':
+        Usage(argv[0]);
+        return 0;
+      default:
+        Usage(argv[0]);
+        return 2;
+    }
+  }
+
+  printf("Press Ctrl+C to exit.\n\n");
+  printf("Server opening...\n");
+
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = SignalHandler;
+  sigaction(SIGINT,  &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  signal(SIGPIPE, SIG_IGN);
+
+  listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port        = htons((uint16_t)port);
+  if ((listen_fd < 0) ||
+      (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0) ||
+      (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+      (listen(listen_fd, SOMAXCONN) != 0)) {
+    printf("Server open error: %s\n\n", strerror(errno));
+    return 1;
+  }
+  EpollFd = epoll_create1(EPOLL_CLOEXEC);
+  event.events   = EPOLLIN;
+  event.data.ptr = NULL;
+  if ((EpollFd < 0) || (epoll_ctl(EpollFd, EPOLL_CTL_ADD, listen_fd, &event) != 0)) {
+    printf("Server open error: %s\n\n", strerror(errno));
+    return 1;
+  }
+  printf("  Server port: %u\n\n", port);
+  printf("Server Opened.\n\n");
+  fflush(stdout);
+
+  expire = Now() + (EXPIRE_INTERVAL / 1000.0);
+  while (Exit == 0) {
+    count = epoll_wait(EpollFd, events, MAX_EVENTS, EXPIRE_INTERVAL);
+    for (i = 0; i < count; i++) {
+      conn = events[i].data.ptr;
+      if (conn == NULL) {
+        ServerAccept(listen_fd);
+        continue;
+      }
+      if ((events[i].events & EPOLLOUT) != 0U) {
+        ConnFlush(conn);
+      }
+      if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0U) {
+        // One receive per event keeps connections served in turn
+        n = recv(conn->fd, RecvBuf, sizeof(RecvBuf), 0);
+        if (n > 0) {
+          ConnParse(conn, RecvBuf, (uint32_t)n);
+        } else if ((n == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))) {
+          ConnClose(conn);
+        }
+      }
+    }
+    if (Now() >= expire) {
+      SessionExpire();
+      expire = Now() + (EXPIRE_INTERVAL / 1000.0);
+    }
+    fflush(stdout);
+  }
+
+  for (conn = Conns; conn != NULL; conn = conn->next) {
+    ScopeClose(&conn->local);
+  }
+  for (session = Sessions; session != NULL; session = session->next) {
+    ScopeClose(&session->scope);
+  }
+  close(EpollFd);
+  close(listen_fd);
+  printf("\nExit\n\n");
+  return 0;
+}
@@ -17,40 +17,187 @@
 # SDS I/O Server
 
 import argparse
+import os
 import sys
+import threading
 
 import os.path as path
 import serial
 import socket
-import errno
+import time
+from struct import unpack_from
+
+sys.path.append(path.join(path.dirname(path.abspath(__file__)), "..", "SDS-Lib"))
+import sds_container
+
+# Default TCP port of live viewers (same as sds_live.DEFAULT_PORT; sds_live requires numpy and is imported
+# only with option --live)
+LIVE_PORT = 5051
+
+# Size of receive buffer of a connection
+RECV_SIZE = 256 * 1024
+
+# SDS I/O request header size
+HEADER_SIZE = 16
+
+# Container stream (file interface of a stream written to a container file)
+class sdsio_container_stream:
+    def __init__(self, group, stream_id):
+        self.group     = group
+        self.stream_id = stream_id
+        self.name      = f"{group.name}:{stream_id}"
+
+    def write(self, data):
+        with self.group.lock:
+            self.group.writer.write(self.stream_id, data)
+
+    def flush(self):
+        with self.group.lock:
+            self.group.writer.flush()
+
+    def close(self):
+        self.group.close(self.stream_id)
+
+# Container group (streams of a session or connection written to one container file)
+class sdsio_container_group:
+    def __init__(self, name, on_close):
+        self.name     = name
+        self.writer   = sds_container.ContainerWriter(open(name, "wb"))
+        self.streams  = set()
+        self.on_close = on_close
+        self.lock     = threading.Lock()
+
+    # Close stream, close container file with its last stream
+    def close(self, stream_id):
+        with self.lock:
+            self.writer.closeStream(stream_id)
+            self.streams.discard(stream_id)
+            if len(self.streams) == 0:
+                self.writer.close()
+                self.on_close(self)
+
+# Stream (file written by write requests of a connection)
+class sdsio_stream:
+    def __init__(self, file, connection, live_id):
+        self.file       = file
+        self.connection = connection
+        self.live_id    = live_id       # Stream identifier of live publisher
+        self.size       = 0             # Number of bytes written
+        self.lock       = threading.Lock()
+
+# Stream scope: streams of a session or of a connection without session.
+# Stream identifiers are numbered per scope, so streams of different devices do not collide.
+class sdsio_scope:
+    def __init__(self, address, session_id=None):
+        self.address           = address    # Address of device
+        self.session_id        = session_id
+        self.stream_identifier = 0
+        self.streams           = {}         # Stream id: sdsio_stream
+        self.out_dir           = None       # Output directory (created with first stream)
+        self.container_group   = None
+        self.connections       = set()      # Connections of session
+        self.detached          = None       # Time when last connection of session was closed
+
+# Connection of a device (socket connection or serial port)
+class sdsio_connection:
+    def __init__(self, address, name):
+        self.address = address              # Address of device (output subdirectory)
+        self.name    = name
+        self.local   = sdsio_scope(address) # Streams opened without session
+        self.session = None                 # Session scope (None when client does not use sessions)
+
+    # Scope of stream identifiers used on connection
+    def scope(self):
+        return self.session if self.session is not None else self.local
 
 # SDS I/O Manager
+# Requests of different connections are executed concurrently: stream tables are protected by the manager lock,
+# data of a stream is written under the lock of the stream.
 class sdsio_manager:
-    def __init__(self, out_dir):
-        self.stream_identifier = 0
-        self.stream_files = {}
+    def __init__(self, out_dir, session_timeout=300, container=False, meta_dir=None, publisher=None, subdirs=False):
+        self.session_identifier = 0
+        self.sessions = {}
+        self.session_timeout = session_timeout
         self.out_dir = out_dir
+        self.container = container
+        self.meta_dir = meta_dir if meta_dir is not None else out_dir
+        self.subdirs = subdirs
+        self.publisher = publisher
+        self.live_identifier = 0
+        self.connections = set()
+        self.lock = threading.RLock()
+
+    # Metadata of stream (content of <name>.sds.yml in metadata directory, empty when not found)
+    def __metadata(self, name):
+        try:
+            with open(path.join(self.meta_dir, f"{name}.sds.yml"), "r") as f:
+                return f.read()
+        except OSError:
+            return ""
+
+    # Output directory of scope: output directory, or with subdirectories
+    # <out_dir>/<device address> for connections without session and <out_dir>/<device address>/Session.<index>
+    def __outDir(self, scope):
+        if scope.out_dir is None:
+            if not self.subdirs:
+                scope.out_dir = self.out_dir
+            else:
+                out_dir = path.join(self.out_dir, scope.address)
+                if scope.session_id is not None:
+                    dir_index = 0
+                    while path.exists(path.join(out_dir, f"Session.{dir_index}")):
+                        dir_index = dir_index + 1
+                    out_dir = path.join(out_dir, f"Session.{dir_index}")
+                os.makedirs(out_dir, exist_ok=True)
+                scope.out_dir = out_dir
+        return scope.out_dir
+
+    # Open stream in container file of scope, open container file with first stream
+    def __openContainerStream(self, name, scope, stream_id):
+        group = scope.container_group
+        if group is None:
+            file_index = 0
+            fname = path.join(self.__outDir(scope), f"Capture.{file_index}.sdsc")
+            while path.exists(fname) == True:
+                file_index = file_index + 1
+                fname = path.join(self.__outDir(scope), f"Capture.{file_index}.sdsc")
+            group = sdsio_container_group(fname, lambda g: setattr(scope, "container_group", None))
+            scope.container_group = group
+        with group.lock:
+            group.writer.addStream(stream_id, name, self.__metadata(name))
+            group.streams.add(stream_id)
+        return sdsio_container_stream(group, stream_id)
 
     # Open
-    def __open(self, mode, name):
+    def __open(self, mode, name, connection):
         file_index = 0
         response = bytearray()
 
         if mode == 1:
             # Write mode
-            fname = f"{self.out_dir}\\{name}.{file_index}.sds"
-            while path.exists(fname) == True:
-                file_index = file_index + 1
-                fname = f"{self.out_dir}\\{name}.{file_index}.sds"
+            scope = connection.scope()
+            fname = name
             try:
-                f = open(fname, "wb")
-                self.stream_identifier += 1
-                self.stream_files.update({self.stream_identifier: f})
+                stream_id = scope.stream_identifier + 1
+                if self.container:
+                    f = self.__openContainerStream(name, scope, stream_id)
+                    fname = f.name
+                else:
+                    fname = path.join(self.__outDir(scope), f"{name}.{file_index}.sds")
+                    while path.exists(fname) == True:
+                        file_index = file_index + 1
+                        fname = path.join(self.__outDir(scope), f"{name}.{file_index}.sds")
+                    f = open(fname, "wb")
+                scope.stream_identifier = stream_id
+                self.live_identifier += 1
+                scope.streams.update({stream_id: sdsio_stream(f, connection, self.live_identifier)})
+                if self.publisher is not None:
+                    self.publisher.streamOpen(self.live_identifier, name, self.__metadata(name))
 
                 command   = 1
                 data_size = 0
                 response.extend(command.to_bytes(4, byteorder='little'))
-                response.extend(self.stream_identifier.to_bytes(4, byteorder='little'))
+                response.extend(stream_id.to_bytes(4, byteorder='little'))
                 response.extend(mode.to_bytes(4, byteorder='little'))
                 response.extend(data_size.to_bytes(4, byteorder='little'))
             except Exception as e:
@@ -62,80 +209,249 @@ class sdsio_manager:
 
             return response
 
+    # Close stream of scope
+    def __closeStream(self, scope, id):
+        stream = scope.streams.pop(id, None)
+        if stream is None:
+            return
+        with stream.lock:
+            try:
+                stream.file.close()
+            except Exception as e:
+                print(f"Could not close file {stream.file.name}. Error: {e}\n")
+            if self.publisher is not None:
+                self.publisher.streamClose(stream.live_id)
+
     # Close
-    def __close(self, id):
+    def __close(self, id, connection):
         response = bytearray()
+        self.__closeStream(connection.scope(), id)
+        return response
 
-        try:
-            self.stream_files.get(id).close()
-            self.stream_files.pop(id)
-        except Exception as e:
-            print(f"Could not close file {self.stream_files.get(id)}. Error: {e}\n")
+    # Write data of complete write request and acknowledge with number of bytes persisted when requested
+    # (argument bit 0). The stream size counts complete write requests only, so a request cut off by a lost
+    # connection is neither written nor reported as persisted on resume.
+    #   data: request data (memoryview of receive buffer, valid during the call)
+    def write(self, id, argument, data, connection):
+        response = bytearray()
+
+        stream = connection.scope().streams.get(id)
+        if stream is None:
+            print(f"Could not write to stream {id}\n")
+
+        persisted = 0
+        if stream is not None:
+            with stream.lock:
+                try:
+                    if len(data) != 0:
+                        stream.file.write(data)
+                        stream.size += len(data)
+                        if self.publisher is not None:
+                            self.publisher.streamWrite(stream.live_id, data)
+                    if argument & 1:
+                        stream.file.flush()
+                except Exception as e:
+                    print(f"Could not write to file {stream.file.name}. Error: {e}\n")
+                persisted = stream.size & 0xFFFFFFFF
+
+        if argument & 1:
+            command   = 7
+            data_size = 0
+            response.extend(command.to_bytes(4, byteorder='little'))
+            response.extend(id.to_bytes(4, byteorder='little'))
+            response.extend(persisted.to_bytes(4, byteorder='little'))
+            response.extend(data_size.to_bytes(4, byteorder='little'))
         return response
 
-    # Write
-    def __write(self, id, data):
+    # Session: continue existing session or start a new one
+    def __session(self, session_id, connection):
         response = bytearray()
 
-        try:
-            self.stream_files.get(id).write(data)
-        except Exception as e:
-            print(f"Could not write to file {self.stream_files.get(id)}. Error: {e}\n")
+        session = self.sessions.get(session_id)
+        if session is not None:
+            print(f"  Session {session_id} resumed\n")
+        else:
+            self.session_identifier += 1
+            session_id = self.session_identifier
+            session = sdsio_scope(connection.address, session_id)
+            self.sessions.update({session_id: session})
+        if connection.session is not None:
+            self.__detach(connection)
+        connection.session = session
+        session.connections.add(connection)
+        session.detached = None
+
+        command   = 5
+        sdsio_id  = 0
+        data_size = 0
+        response.extend(command.to_bytes(4, byteorder='little'))
+        response.extend(sdsio_id.to_bytes(4, byteorder='little'))
+        response.extend(session_id.to_bytes(4, byteorder='little'))
+        response.extend(data_size.to_bytes(4, byteorder='little'))
         return response
 
+    # Resume: stream continues on connection, respond with number of bytes persisted
+    def __resume(self, id, connection):
+        response = bytearray()
+
+        stream = connection.session.streams.get(id) if connection.session is not None else None
+        if stream is not None:
+            with stream.lock:
+                stream.connection = connection
+                stream.file.flush()
+                persisted = stream.size & 0xFFFFFFFF
+        else:
+            print(f"Could not resume stream {id}\n")
+            id = 0
+            persisted = 0
+
+        command   = 6
+        data_size = 0
+        response.extend(command.to_bytes(4, byteorder='little'))
+        response.extend(id.to_bytes(4, byteorder='little'))
+        response.extend(persisted.to_bytes(4, byteorder='little'))
+        response.extend(data_size.to_bytes(4, byteorder='little'))
+        return response
+
+    # Detach connection from its session (streams are kept for resume within session timeout)
+    def __detach(self, connection):
+        session = connection.session
+        session.connections.discard(connection)
+        if len(session.connections) == 0:
+            session.detached = time.monotonic()
+
+    # Close streams of sessions which were not resumed within session timeout
+    def expire_sessions(self):
+        with self.lock:
+            now = time.monotonic()
+            for session_id, session in list(self.sessions.items()):
+                if (session.detached is not None) and ((now - session.detached) >= self.session_timeout):
+                    print(f"  Session {session_id} expired\n")
+                    for id in list(session.streams):
+                        self.__closeStream(session, id)
+                    self.sessions.pop(session_id)
+
     # Clear
     def clear(self):
-        id_list = list()
-        for id in self.stream_files:
-            id_list.append(id)
-        for id in id_list:
-            self.__close(id)
-
-    # Execute request
-    def execute_request (self, request_buf):
+        with self.lock:
+            for scope in [c.local for c in self.connections] + list(self.sessions.values()):
+                for id in list(scope.streams):
+                    self.__closeStream(scope, id)
+
+    # Connection opened
+    def open_connection(self, connection):
+        with self.lock:
+            self.connections.add(connection)
+
+    # Connection closed: close its streams or keep them for session resume
+    def close_connection(self, connection):
+        with self.lock:
+            self.connections.discard(connection)
+            for id in list(connection.local.streams):
+                self.__closeStream(connection.local, id)
+            if connection.session is not None:
+                self.__detach(connection)
+
+    # Execute request (other than write)
+    #   data: request data (memoryview of receive buffer, valid during the call)
+    def execute_request (self, command, sdsio_id, argument, data, connection):
         response = bytearray()
 
-        command   = int.from_bytes(request_buf[0:4],   'little')
-        sdsio_id  = int.from_bytes(request_buf[4:8],   'little')
-        argument  = int.from_bytes(request_buf[8:12],  'little')
-        data_size = int.from_bytes(request_buf[12:16], 'little')
-        data      = request_buf[16:16 + data_size]
-
-        # Open
-        if command == 1:
-            response = self.__open(argument, data.decode('utf-8').split("\0")[0])
-        # Close
-        elif command == 2:
-            self.__close(sdsio_id)
-        # Write
-        elif command == 3:
-            self.__write(sdsio_id, data)
-        # Invalid command
-        else:
-            print(f"Invalid command: {command}")
+        with self.lock:
+            # Open
+            if command == 1:
+                response = self.__open(argument, bytes(data).decode('utf-8').split("\0")[0], connection)
+            # Close
+            elif command == 2:
+                self.__close(sdsio_id, connection)
+            # Session
+            elif command == 5:
+                response = self.__session(argument, connection)
+            # Resume
+            elif command == 6:
+                response = self.__resume(sdsio_id, connection)
+            # Invalid command
+            else:
+                print(f"Invalid command: {command}")
         return response
 
+# Request parser (one per connection)
+# Data is received into one buffer and parsed without copying: requests are executed when they are complete in
+# the buffer and write data is written to the stream directly from the buffer. Only an incomplete request is moved
+# to the start of the buffer.
+class sdsio_request_parser:
+    def __init__(self, manager, connection, buf_size=RECV_SIZE):
+        self.manager    = manager
+        self.connection = connection
+        self.buf        = bytearray(buf_size)
+        self.view       = memoryview(self.buf)
+        self.fill       = 0             # Number of bytes in buffer (not yet parsed)
+
+    # Free space of receive buffer (filled by recv_into or readinto)
+    def buffer(self):
+        return self.view[self.fill:]
+
+    # Parse size bytes received into buffer, execute requests and return responses
+    def parse(self, size):
+        responses = []
+        end = self.fill + size
+        pos = 0
+        request_size = 0
+
+        while (end - pos) >= HEADER_SIZE:
+            command, sdsio_id, argument, data_size = unpack_from("<4I", self.buf, pos)
+            if (end - pos) < (HEADER_SIZE + data_size):
+                # Request not complete. Read new data
+                request_size = HEADER_SIZE + data_size
+                break
+            data = self.view[pos + HEADER_SIZE:pos + HEADER_SIZE + data_size]
+            pos += HEADER_SIZE + data_size
+            if command == 3:
+                response = self.manager.write(sdsio_id, argument, data, self.connection)
+            else:
+                response = self.manager.execute_request(command, sdsio_id, argument, data, self.connection)
+            if response:
+                responses.append(bytes(response))
+
+        # Keep unparsed bytes (incomplete header or request) at the start of the buffer,
+        # buffer grows for requests larger than the buffer
+        self.fill = end - pos
+        if request_size > len(self.buf):
+            buf = bytearray(request_size)
+            buf[0:self.fill] = self.view[pos:end]
+            self.buf  = buf
+            self.view = memoryview(buf)
+        elif (self.fill != 0) and (pos != 0):
+            self.buf[0:self.fill] = bytes(self.view[pos:end])
+        return responses
+
 # Server - Socket
+# Each connection is served by its own thread, so devices are recorded concurrently.
 class sdsio_server_socket:
     def __init__(self, port):
         self.port           = port
         self.sock_listening = None
-        self.sock           = None
+        self.connections    = {}
+        self.lock           = threading.Lock()
 
     # socket accept
-    def __accept(self):
-        while True:
-            try:
-                # Accept
-                self.sock, addr = self.sock_listening.accept()
-                self.sock.setblocking(False)
-                break
-            except Exception as e:
-                if (e.errno == errno.EWOULDBLOCK) or (e.errno == errno.EAGAIN):
-                    continue
-                else:
-                    print(f"Server open error: {e.errno}\n")
-                    sys.exit(1)
+    # Return tuple (connection socket, sdsio_connection) or None when no client connected within timeout
+    def accept(self, timeout=0.5):
+        self.sock_listening.settimeout(timeout)
+        try:
+            # Accept
+            sock, addr = self.sock_listening.accept()
+        except socket.timeout:
+            return None
+        except Exception as e:
+            print(f"Server accept error: {e}\n")
+            sys.exit(1)
+        sock.settimeout(None)
+        print(f"  Client connected: {addr[0]}:{addr[1]}\n")
+        connection = sdsio_connection(addr[0].replace(":", "_"), f"{addr[0]}:{addr[1]}")
+        with self.lock:
+            self.connections.update({connection: sock})
+        return sock, connection
 
     # Open socket server
     def open(self):
@@ -153,44 +469,42 @@ class sdsio_server_socket:
                                                 socket.SOCK_STREAM) # TCP
             self.sock_listening.bind((ip, self.port))
             self.sock_listening.listen()
-            self.sock_listening.setblocking(False)
         except Exception as e:
             print(f"Server open error: {e}\n")
             sys.exit(1)
 
-        self.__accept()
-
-    # Close socket server
+    # Close socket server (connection threads return when their connection is shut down)
     def close(self):
-        self.sock.close()
+        with self.lock:
+            for sock in self.connections.values():
+                try:
+                    sock.shutdown(socket.SHUT_RDWR)
+                except OSError:
+                    pass
         self.sock_listening.close()
 
-    # Read
-    def read(self, size):
-        try:
-            data = self.sock.recv(size)
-            if data:
-                return data
-            else:
-                self.__accept()
-        except Exception as e:
-            if (e.errno == errno.EWOULDBLOCK) or (e.errno == errno.EAGAIN):
-                return None
-            else:
-                print(f"Server read error: {e}\n")
-                sys.exit(1)
-
-    # Write
-    def write(self, data):
-        size = 0
+    # Connection thread: execute requests received on connection and send responses until it is closed
+    def serve(self, sock, connection, manager):
+        parser = sdsio_request_parser(manager, connection)
+        manager.open_connection(connection)
         try:
-            size = self.sock.send(data)
-        except Exception as e:
-            if (e.errno == errno.EWOULDBLOCK) or (e.errno == errno.EAGAIN):
-                return size
-            else:
-                print(f"Server write error: {e}\n")
-                sys.exit(1)
+            while True:
+                try:
+                    size = sock.recv_into(parser.buffer())
+                except OSError:
+                    size = 0
+                if size == 0:
+                    break
+                for response in parser.parse(size):
+                    sock.sendall(response)
+        except OSError as e:
+            print(f"Server write error: {e}\n")
+        finally:
+            manager.close_connection(connection)
+            with self.lock:
+                self.connections.pop(connection, None)
+            sock.close()
+            print(f"  Client disconnected: {connection.name}\n")
 
 # Server - Serial
 class sdsio_server_serial:
@@ -226,13 +540,14 @@ class sdsio_server_serial:
     def close(self):
         self.ser.close()
 
-    # Read
-    def read(self, size):
+    # Read into buffer, return number of bytes read
+    def read(self, buf):
         try:
-            return self.ser.read(size)
+            size = self.ser.readinto(buf)
         except Exception as e:
             print(f"Serial read error: {e}\n")
             sys.exit(1)
+        return size or 0
 
     # Write
     def write(self, data):
@@ -259,6 +574,21 @@ def main():
                                         help="TCP port (default: 5050)", type=int, default=5050)
     parser_socket_optional.add_argument("--outdir", dest="out_dir", metavar="<Output dir>",
                                         help="Output directory", default=".")
+    parser_socket_optional.add_argument("--subdirs", dest="subdirs",
+                                        help="Write recordings of each device and session to output subdirectory <device address>/Session.<index>",
+                                        action="store_true")
+    parser_socket_optional.add_argument("--container", dest="container",
+                                        help="Write streams of a session to one container file (Capture.<index>.sdsc)",
+                                        action="store_true")
+    parser_socket_optional.add_argument("--metadir", dest="meta_dir", metavar="<Metadata dir>",
+                                        help="Directory with <name>.sds.yml files embedded into container files (default: output directory)",
+                                        default=None)
+    parser_socket_optional.add_argument("--session-timeout", dest="session_timeout", metavar="<Timeout>",
+                                        help="Time in seconds to keep streams of a disconnected session open for resume (default: 300)",
+                                        type=float, default=300)
+    parser_socket_optional.add_argument("--live", dest="live", metavar="<Live port>",
+                                        help=f"Publish written stream data to live viewers on local TCP port (default: {LIVE_PORT})",
+                                        type=int, nargs="?", const=LIVE_PORT, default=None)
 
     parser_serial = subparsers.add_parser("serial", formatter_class=formatter)
     parser_serial_required = parser_serial.add_argument_group("required")
@@ -281,80 +611,78 @@ def main():
                                         help=help_str, default=serial.STOPBITS_ONE)
     parser_serial_optional.add_argument("--outdir", dest="out_dir", metavar="<Output dir>",
                                         help="Output directory", default=".")
+    parser_serial_optional.add_argument("--subdirs", dest="subdirs",
+                                        help="Write recordings of each session to output subdirectory <serial port>/Session.<index>",
+                                        action="store_true")
+    parser_serial_optional.add_argument("--container", dest="container",
+                                        help="Write streams to one container file (Capture.<index>.sdsc)",
+                                        action="store_true")
+    parser_serial_optional.add_argument("--metadir", dest="meta_dir", metavar="<Metadata dir>",
+                                        help="Directory with <name>.sds.yml files embedded into container files (default: output directory)",
+                                        default=None)
+    parser_serial_optional.add_argument("--live", dest="live", metavar="<Live port>",
+                                        help=f"Publish written stream data to live viewers on local TCP port (default: {LIVE_PORT})",
+                                        type=int, nargs="?", const=LIVE_PORT, default=None)
 
     args = parser.parse_args()
 
-    stream_buf_cnt   = 0
-
-    header_size      = 16
-    header_buf       = bytearray()
-
-    request_buf_size = 0
-    request_buf      = bytearray()
+    publisher = None
+    if args.live is not None:
+        try:
+            import sds_live
+        except ImportError as e:
+            print(f"Live view requires numpy: {e}\n")
+            sys.exit(1)
+        publisher = sds_live.Publisher(args.live)
 
-    manager = sdsio_manager(args.out_dir)
+    manager = sdsio_manager(args.out_dir, getattr(args, "session_timeout", 300), args.container, args.meta_dir, publisher,
+                            args.subdirs)
 
     if args.server_type == "socket":
         server = sdsio_server_socket(args.port)
     elif args.server_type == "serial":
         server = sdsio_server_serial(args.port, args.baudrate, args.parity, args.stop_bits)
 
+    threads = []
     try:
         print("Server opening...")
         server.open()
+        if publisher is not None:
+            try:
+                publisher.open()
+            except Exception as e:
+                print(f"Live publisher open error: {e}\n")
+                sys.exit(1)
+            print(f"  Live port: {args.live}\n")
         print("Server Opened.\n")
 
+        if args.server_type == "serial":
+            # Serial port is a single connection served by the main loop
+            connection = sdsio_connection(path.basename(str(args.port)), args.port)
+            manager.open_connection(connection)
+            parser = sdsio_request_parser(manager, connection)
+
         while True:
 
-            stream_buf = server.read(8192)
-            stream_buf_cnt = 0
-
-            while stream_buf != None and stream_buf_cnt < len(stream_buf):
-
-                if request_buf_size == 0:
-                    # Request buffer is empty. Get new request
-                    cnt = header_size - len(header_buf)
-                    if cnt > (len(stream_buf) - stream_buf_cnt):
-                        cnt = len(stream_buf) - stream_buf_cnt
-                    header_buf.extend(stream_buf[stream_buf_cnt: stream_buf_cnt + cnt])
-                    stream_buf_cnt += cnt
-
-                    if len(header_buf) != header_size:
-                        # Header not complete. Read new data
-                        break
-                    else:
-                        # New request
-                        request_buf = bytearray()
-                        request_buf.extend(header_buf)
-                        request_buf_size = int.from_bytes(header_buf[12:16], 'little') + header_size
-                        # Clear Header buffer
-                        del header_buf[0:]
-
-                cnt = request_buf_size - len(request_buf)
-                if cnt > (len(stream_buf) - stream_buf_cnt):
-                    # Not all data is yet available.
-                    cnt = len(stream_buf) - stream_buf_cnt
-
-                # Copy request data
-                request_buf.extend(stream_buf[stream_buf_cnt : stream_buf_cnt + cnt])
-
-                # Update data count
-                stream_buf_cnt += cnt
-
-                if len(request_buf) == request_buf_size:
-                    # Whole request is prepared. Execute request.
-                    response = manager.execute_request(request_buf)
-
-                    # Reset request buffer size. New request can now be processed.
-                    request_buf_size = 0
-
-                    # Send response
-                    if response:
-                        try:
-                            server.write(bytes(response))
-                        except socket.error as e:
-                            print(f"Socket send error: {e}\n")
-                            sys.exit(1)
+            # Live viewers are accepted and data queued for them is sent between reads
+            timeout = 0.5
+            if publisher is not None:
+                timeout = 0.01 if publisher.pending() else 0.05
+            if args.server_type == "socket":
+                accepted = server.accept(timeout)
+                if accepted is not None:
+                    thread = threading.Thread(target=server.serve, args=(*accepted, manager), daemon=True)
+                    thread.start()
+                    threads.append(thread)
+                threads = [thread for thread in threads if thread.is_alive()]
+            else:
+                # Send responses
+                for response in parser.parse(server.read(parser.buffer())):
+                    server.write(response)
+
+            manager.expire_sessions()
+            if publisher is not None:
+                publisher.poll()
 
     except KeyboardInterrupt:
         try:
@@ -362,7 +690,11 @@ def main():
         except Exception:
             # If server.close() raises an exception, don't print the error
             pass
+        for thread in threads:
+            thread.join(1.0)
         manager.clear()
+        if publisher is not None:
+            publisher.close()
         print("\nExit\n")
         sys.exit(0)
 
@@ -0,0 +1,230 @@
+# Copyright (c) 2023 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# SDS I/O Server load test (concurrent session clients writing one stream each, aggregate data rate)
+
+import argparse
+import os
+import shutil
+import signal
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+from os import path
+from struct import pack, unpack
+
+# SDS I/O commands
+CMD_OPEN    = 1
+CMD_CLOSE   = 2
+CMD_WRITE   = 3
+CMD_SESSION = 5
+CMD_ACK     = 7
+
+# SDS I/O request header size
+HEADER_SIZE = 16
+
+# Stream name written by each client
+STREAM_NAME = "Load"
+
+# Time in seconds to wait for the server to accept connections
+START_TIMEOUT = 10
+
+
+# SDS I/O request header
+def header(command, sdsio_id, argument, data_size=0):
+    return pack("<4I", command, sdsio_id, argument, data_size)
+
+
+# Receive response header, return tuple (command, sdsio_id, argument, data_size)
+def response(sock):
+    buf = b""
+    while len(buf) < HEADER_SIZE:
+        data = sock.recv(HEADER_SIZE - len(buf))
+        if len(data) == 0:
+            raise ConnectionError("Connection closed by server")
+        buf += data
+    return unpack("<4I", buf)
+
+
+# Unused TCP port on localhost
+def freePort():
+    with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as sock:
+        sock.bind(("127.0.0.1", 0))
+        return sock.getsockname()[1]
+
+
+# Start server writing to out_dir, return process when it accepts connections
+def startServer(args, port, out_dir):
+    here = path.dirname(path.abspath(__file__))
+    if args.native:
+        command = [path.join(here, "..", "native", "sdsio-server")]
+    else:
+        command = [sys.executable, path.join(here, "..", "sdsio-server.py"), "socket"]
+    command += ["--port", str(port), "--outdir", out_dir, "--subdirs"]
+
+    try:
+        server = subprocess.Popen(command, stdout=subprocess.DEVNULL)
+    except OSError as e:
+        sys.exit(f"Error: {e}")
+
+    deadline = time.monotonic() + START_TIMEOUT
+    while time.monotonic() < deadline:
+        if server.poll() is not None:
+            sys.exit(f"Error: Server exited with code {server.returncode}")
+        try:
+            socket.create_connection(("127.0.0.1", port), timeout=1).close()
+            return server
+        except OSError:
+            time.sleep(0.1)
+    stopServer(server)
+    sys.exit("Error: Server does not accept connections")
+
+
+def stopServer(server):
+    if sys.platform == "win32":
+        server.terminate()
+    else:
+        server.send_signal(signal.SIGINT)
+    try:
+        server.wait(timeout=START_TIMEOUT)
+    except subprocess.TimeoutExpired:
+        server.kill()
+        server.wait()
+
+
+# Client: start session, open stream and write size bytes in requests of chunk_size bytes,
+# return number of bytes acknowledged by the server
+def client(port, index, size, chunk_size):
+    with socket.create_connection(("127.0.0.1", port)) as sock:
+        sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        sock.sendall(header(CMD_SESSION, 0, 0))
+        response(sock)
+
+        name = STREAM_NAME.encode("utf-8") + b"\0"
+        sock.sendall(header(CMD_OPEN, 0, 1, len(name)) + name)
+        _, sdsio_id, _, _ = response(sock)
+        if sdsio_id == 0:
+            raise RuntimeError("Open failed")
+
+        chunk = bytes([index & 0xFF]) * chunk_size
+        sent  = 0
+        while sent < size:
+            n = min(chunk_size, size - sent)
+            sock.sendall(header(CMD_WRITE, sdsio_id, 0, n) + chunk[:n])
+            sent += n
+
+        # Empty write with acknowledge request returns the number of bytes persisted
+        sock.sendall(header(CMD_WRITE, sdsio_id, 1))
+        command, _, persisted, _ = response(sock)
+        if command != CMD_ACK:
+            raise RuntimeError(f"Unexpected response: {command}")
+        sock.sendall(header(CMD_CLOSE, sdsio_id, 0))
+        return persisted
+
+
+# Check files written by clients (one session subdirectory per client), return list of errors
+def checkFiles(out_dir, clients, size):
+    errors = []
+    base = path.join(out_dir, "127.0.0.1")
+    dirs = sorted(os.listdir(base)) if path.isdir(base) else []
+    if len(dirs) != clients:
+        errors.append(f"{len(dirs)} session directories, expected {clients}")
+    for sub in dirs:
+        filename = path.join(base, sub, f"{STREAM_NAME}.0.sds")
+        try:
+            with open(filename, "rb") as file:
+                data = file.read()
+        except OSError as e:
+            errors.append(str(e))
+            continue
+        if (len(data) != size) or (data.count(data[:1]) != len(data)):
+            errors.append(f"{filename}: {len(data)} bytes, expected {size} bytes of one client")
+    return errors
+
+
+# Main function
+def main():
+    formatter = lambda prog: argparse.HelpFormatter(prog, max_help_position=41)
+    parser = argparse.ArgumentParser(formatter_class=formatter,
+                                     description="SDS I/O server load test (concurrent session clients)")
+
+    optional = parser.add_argument_group("optional")
+    optional.add_argument("--clients", dest="clients", metavar="<Clients>",
+                            help="Number of concurrent clients (default: %(default)s)", type=int, default=16)
+    optional.add_argument("--size", dest="size", metavar="<MB>",
+                            help="Data written by each client in MB (default: %(default)s)", type=int, default=8)
+    optional.add_argument("--chunk", dest="chunk", metavar="<KB>",
+                            help="Data size of write requests in KB (default: %(default)s)", type=int, default=128)
+    optional.add_argument("--native", dest="native",
+                            help="Test native server (native/sdsio-server) instead of sdsio-server.py",
+                            action="store_true")
+    optional.add_argument("--outdir", dest="out_dir", metavar="<Output dir>",
+                            help="Output directory of server, kept after test (default: temporary directory)",
+                            default=None)
+
+    args = parser.parse_args()
+
+    if (args.clients < 1) or (args.size < 1) or (args.chunk < 1):
+        sys.exit("Error: Clients, size and chunk must be at least 1")
+
+    size       = args.size * 1024 * 1024
+    chunk_size = args.chunk * 1024
+    out_dir    = args.out_dir if args.out_dir is not None else tempfile.mkdtemp(prefix="sdsio-load-")
+    os.makedirs(out_dir, exist_ok=True)
+
+    port   = freePort()
+    server = startServer(args, port, out_dir)
+
+    results = [None] * args.clients
+    def run(index):
+        try:
+            results[index] = client(port, index, size, chunk_size)
+        except Exception as e:
+            results[index] = e
+
+    try:
+        threads = [threading.Thread(target=run, args=(n,)) for n in range(args.clients)]
+        start = time.monotonic()
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        duration = time.monotonic() - start
+    finally:
+        stopServer(server)
+
+    errors = [f"Client {n}: {result}" for n, result in enumerate(results) if isinstance(result, Exception)]
+    errors += [f"Client {n}: {result} bytes acknowledged, expected {size & 0xFFFFFFFF}"
+               for n, result in enumerate(results)
+               if not isinstance(result, Exception) and (result != (size & 0xFFFFFFFF))]
+    if len(errors) == 0:
+        errors = checkFiles(out_dir, args.clients, size)
+    if args.out_dir is None:
+        shutil.rmtree(out_dir, ignore_errors=True)
+
+    total = args.clients * size
+    print(f"{args.clients} clients x {args.size} MB in {duration:.2f} s: {total / 1e6 / duration:.0f} MB/s")
+    for error in errors:
+        print(f"Error: {error}")
+    if len(errors) != 0:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()